@@ -2,7 +2,7 @@
  * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
  * @Date        : 2024-11-28 22:40:42
  * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
- * @LastEditTime: 2024-11-29 15:31:50
+ * @LastEditTime: 2026-10-18 10:02:16
  * @FilePath    : /shellhome-nightlamp/main/app_main.c
  * @Description :
  * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
@@ -13,24 +13,99 @@
 #include "freertos/event_groups.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 
+#include "board_mem.h"
+#include "board_bench.h"
+#include "board_pm.h"
 #include "board_leds.h"
 #include "board_sensor.h"
+#include "board_sync.h"
+#include "board_stats.h"
+#include "board_telemetry.h"
+#include "board_trace.h"
 
 
 static const char *TAG = "LAMP";
 EventGroupHandle_t g_event_group;
+MEM_EVENT_GROUP_DEFINE(event);
 
+#define BOOT_TASK_STACK     (3 * 1024)
+MEM_TASK_DEFINE(boot, BOOT_TASK_STACK);
+
+/* boot phase timestamps */
+#define BOOT_MARK_MAX       8
+
+typedef struct {
+    const char *    name;
+    int64_t           us;
+} boot_mark_t;
+
+static boot_mark_t g_boot_marks[BOOT_MARK_MAX];
+static uint32_t g_boot_mark_num = 0;
+
+static void boot_mark(const char *name) {
+    if (g_boot_mark_num < BOOT_MARK_MAX) {
+        g_boot_marks[g_boot_mark_num].name = name;
+        g_boot_marks[g_boot_mark_num].us = esp_timer_get_time();
+        g_boot_mark_num++;
+    }
+}
+
+static void boot_report(void) {
+    int64_t last = 0;
+    for (uint32_t i = 0; i < g_boot_mark_num; i++) {
+        ESP_LOGI(TAG, "boot %-12s at %8"PRId64" us (+%"PRId64" us)",
+                 g_boot_marks[i].name, g_boot_marks[i].us,
+                 g_boot_marks[i].us - last);
+        last = g_boot_marks[i].us;
+    }
+}
+
+/**
+ * @brief Background boot stage, everything not needed for the first frame
+ *
+ */
+static void boot_task(void *arg) {
+    // init sensor
+    esp_err_t ret = sensor_init();
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "sensor init failed");
+    }
+    boot_mark("sensors");
+
+    // join the other lamps, needs the radio
+    ret = board_sync_init();
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "sync init failed");
+    }
+    boot_mark("sync");
+
+    // stream sensor and frame samples to the host
+    ret = board_telemetry_init();
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "telemetry init failed");
+    }
+
+    boot_report();
+    mem_budget_report();
+    board_bench_run();
+    vTaskDelete(NULL);
+}
 
 void app_main(void)
 {
     esp_err_t ret;
 
+    boot_mark("app_main");
     ESP_LOGI(TAG, "Starting ...");
 
     // init event group
-    g_event_group = xEventGroupCreate();
+    g_event_group = MEM_EVENT_GROUP_CREATE(event, "event_group");
+#ifdef CONFIG_LAMP_TRACE
+    mem_budget_add("trace", board_trace_size(), true);
+#endif
 
     // init NVS
     ret = nvs_flash_init();
@@ -40,22 +115,39 @@ void app_main(void)
         ret = nvs_flash_init();
     }
     ESP_RETURN_VOID_ON_FALSE(ESP_OK == ret, TAG, "nvs flash init failed");
+    boot_mark("nvs");
 
     ESP_LOGI(TAG, "Init ...");
 
-    // init leds
+    // init power management
+    ret = board_pm_init();
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "pm init failed");
+    }
+
+    // init leds with the persisted mode and light the first frame
     ret = leds_init();
     ESP_RETURN_VOID_ON_FALSE(ESP_OK == ret, TAG, "leds init failed");
-
-    // init sensor
-    ret = sensor_init();
-    ESP_RETURN_VOID_ON_FALSE(ESP_OK == ret, TAG, "sensor init failed");
+    boot_mark("leds");
+    leds_show();
+    boot_mark("first light");
 
     // start leds
     ESP_LOGI(TAG, "Start ...");
     ret = leds_start();
     ESP_RETURN_VOID_ON_FALSE(ESP_OK == ret, TAG, "leds start failed");
 
+    // defer sensors and battery to the background stage
+    TaskHandle_t task = MEM_TASK_CREATE(boot, boot_task, "boot",
+                                        BOOT_TASK_STACK, NULL, 1);
+    ESP_RETURN_VOID_ON_FALSE(NULL != task, TAG, "boot task failed");
+
+    // this task renders, the stats hold it to its CPU budget
+    ret = board_stats_init(xTaskGetCurrentTaskHandle());
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "stats init failed");
+    }
+
     // flush lamp
     ESP_LOGI(TAG, "Flushing ...");
     while (true) {
@@ -0,0 +1,259 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 16:40:30
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 16:40:33
+ * @FilePath    : /shellhome-nightlamp/main/board_bench.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+
+#include "board_bench.h"
+#include "lamp_frame.h"
+#include "lamp_fx.h"
+#include "lamp_effect.h"
+#include "lamp_color.h"
+#include "lamp_anim.h"
+#include "lamp_wire.h"
+#include "lamp_compose.h"
+#include "lamp_wave.h"
+
+static const char *TAG = "BENCH";
+
+#ifdef CONFIG_LAMP_FX_BENCH
+
+/**< generated by tools/anim_encode.py --demo at build time */
+#include "lamp_anim_demo.h"
+
+#define BENCH_LEDS      CONFIG_LAMP_FX_BENCH_LEDS
+#define BENCH_ROUNDS    64
+
+typedef void (*bench_fn_t)(const lamp_fx_kernels_t *kernels, uint32_t round);
+
+static uint8_t g_bench_buf[BENCH_LEDS];
+static lamp_rgb_t g_bench_rgb[BENCH_LEDS];
+static uint32_t g_bench_rng = 1;
+
+static void bench_noise(const lamp_fx_kernels_t *kernels, uint32_t round) {
+    kernels->noise_row(g_bench_buf, BENCH_LEDS, 0, 48, round * 12);
+}
+
+static void bench_fire(const lamp_fx_kernels_t *kernels, uint32_t round) {
+    lamp_fire_step(kernels, g_bench_buf, BENCH_LEDS, &g_bench_rng, 55, 120);
+    for (int i = 0; i < BENCH_LEDS; i++) {
+        lamp_heat_color(g_bench_buf[i], &g_bench_rgb[i]);
+    }
+}
+
+/**< a hue sweep over the strip, as the marquee draws it */
+static uint8_t g_bench_wire[BENCH_LEDS * LAMP_PACK_BYTES];
+static uint16_t g_bench_phys[BENCH_LEDS];
+
+/**< the whole strip into the wire format, in order */
+static void bench_pack(const lamp_fx_kernels_t *kernels, uint32_t round) {
+    kernels->pack_grb(g_bench_wire, BENCH_LEDS, g_bench_rgb, NULL, BENCH_LEDS);
+}
+
+/**< and through a layout, wired back to front */
+static void bench_remap(const lamp_fx_kernels_t *kernels, uint32_t round) {
+    kernels->pack_grb(g_bench_wire, BENCH_LEDS, g_bench_rgb, g_bench_phys, BENCH_LEDS);
+}
+
+/**< the whole strip to RMT symbols, two LEDs per call as the ISR refills */
+static void bench_wire(const lamp_fx_kernels_t *kernels, uint32_t round) {
+    static lamp_wire_t wire;
+    static uint32_t symbols[2 * LAMP_WIRE_LED_SYMBOLS];
+
+    if (0 == round) {
+        lamp_wire_init(&wire, 0, 1, 255);
+    }
+    for (uint16_t first = 0; first < BENCH_LEDS; first += 2) {
+        uint16_t num = BENCH_LEDS - first < 2 ? BENCH_LEDS - first : 2;
+        lamp_wire_encode(&wire, g_bench_rgb, g_bench_phys, first, num, symbols);
+    }
+}
+
+/**< one layer of the bench strip over another, the cost per layer */
+static lamp_rgb_t g_bench_layer[BENCH_LEDS];
+
+static void bench_alpha(const lamp_fx_kernels_t *kernels, uint32_t round) {
+    kernels->blend((uint8_t *)g_bench_rgb, (const uint8_t *)g_bench_layer,
+                   sizeof(g_bench_rgb), LAMP_BLEND_ALPHA, 96);
+}
+
+static void bench_add(const lamp_fx_kernels_t *kernels, uint32_t round) {
+    kernels->blend((uint8_t *)g_bench_rgb, (const uint8_t *)g_bench_layer,
+                   sizeof(g_bench_rgb), LAMP_BLEND_ADD, 96);
+}
+
+static void bench_max(const lamp_fx_kernels_t *kernels, uint32_t round) {
+    kernels->blend((uint8_t *)g_bench_rgb, (const uint8_t *)g_bench_layer,
+                   sizeof(g_bench_rgb), LAMP_BLEND_MAX, 96);
+}
+
+static void bench_hsv(const lamp_fx_kernels_t *kernels, uint32_t round) {
+    uint32_t r, g, b;
+
+    for (int i = 0; i < BENCH_LEDS; i++) {
+        lamp_hsv2rgb(round + i, 100, 100, &r, &g, &b);
+        g_bench_rgb[i] = (lamp_rgb_t){r, g, b};
+    }
+}
+
+static void bench_oklch(const lamp_fx_kernels_t *kernels, uint32_t round) {
+    uint32_t r, g, b;
+
+    for (int i = 0; i < BENCH_LEDS; i++) {
+        lamp_oklch2rgb(round + i, 100, 100, &r, &g, &b);
+        g_bench_rgb[i] = (lamp_rgb_t){r, g, b};
+    }
+}
+
+/**< one pulse along the strip, a table shape sampled per pixel */
+static void bench_wave(const lamp_fx_kernels_t *kernels, uint32_t round) {
+    static const lamp_wave_t wave = LAMP_WAVE_INIT(LAMP_WAVE_EXP, 4000);
+
+    for (int i = 0; i < BENCH_LEDS; i++) {
+        g_bench_buf[i] = lamp_wave_at(&wave, round * 16, (uint32_t)i << 24) >> 8;
+    }
+}
+
+/**< one pass over the demo show, frames differ so the minimum would hide the cost */
+static void bench_anim(void) {
+    static lamp_anim_t anim;
+    lamp_anim_mem_t mem;
+    lamp_anim_source_t src;
+    uint32_t total = 0, worst = 0;
+
+    lamp_anim_mem_source(&mem, g_anim_demo, sizeof(g_anim_demo), &src);
+    if (LAMP_ANIM_OK != lamp_anim_open(&anim, &src) || 0 == anim.info.frames) {
+        ESP_LOGW(TAG, "  anim   demo show unreadable");
+        return;
+    }
+    for (uint32_t f = 0; f < anim.info.frames; f++) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        lamp_anim_next(&anim, g_bench_rgb, BENCH_LEDS);
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        total += cycles;
+        worst = cycles > worst ? cycles : worst;
+    }
+    uint32_t avg = total / anim.info.frames;
+    ESP_LOGI(TAG, "  anim   %"PRIu32" frames, %u of %"PRIu32" bytes, %8"PRIu32" cycles avg,"
+             " %8"PRIu32" worst, %6"PRIu32" us avg",
+             anim.info.frames, (unsigned)sizeof(g_anim_demo),
+             anim.info.frames * G_ANIM_DEMO_LEDS * 3, avg, worst,
+             avg / CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+}
+
+/**< full layer stacks of the lamp strip, then only the top layer changed */
+static void bench_compose(void) {
+    static lamp_compose_t comp;
+    static lamp_frame_t frames[LAMP_COMPOSE_LAYERS];
+    static const uint8_t modes[LAMP_COMPOSE_LAYERS] = {
+        LAMP_BLEND_ALPHA, LAMP_BLEND_ADD, LAMP_BLEND_MAX, LAMP_BLEND_ALPHA,
+    };
+
+    for (uint8_t i = 0; i < LAMP_COMPOSE_LAYERS; i++) {
+        memset(&frames[i], 0x40 * i + 0x20, sizeof(lamp_frame_t));
+    }
+    for (uint8_t num = 1; num <= LAMP_COMPOSE_LAYERS; num++) {
+        uint32_t full = UINT32_MAX, top = UINT32_MAX;
+        lamp_compose_init(&comp, lamp_fx_kernels());
+        for (uint8_t i = 0; i < num; i++) {
+            lamp_compose_set(&comp, i, &frames[i], modes[i], i ? 128 : 200);
+        }
+        for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+            for (uint8_t i = 0; i < num; i++) {
+                lamp_compose_touch(&comp, i);
+            }
+            uint32_t start = esp_cpu_get_cycle_count();
+            lamp_compose_frame(&comp);
+            uint32_t cycles = esp_cpu_get_cycle_count() - start;
+            full = cycles < full ? cycles : full;
+
+            lamp_compose_touch(&comp, num - 1);
+            start = esp_cpu_get_cycle_count();
+            lamp_compose_frame(&comp);
+            cycles = esp_cpu_get_cycle_count() - start;
+            top = cycles < top ? cycles : top;
+        }
+        ESP_LOGI(TAG, "  compose %d layers %-5s %8"PRIu32" cycles, %6"PRIu32" per layer,"
+                 " %8"PRIu32" with only the top changed",
+                 num, lamp_fx_kernels()->name, full, full / num, top);
+    }
+}
+
+static const struct {
+    const char     *name;
+    bench_fn_t        fn;
+    bool         kernels;   /**< run once per kernel set */
+} g_bench_cases[] = {
+    {"noise", bench_noise, true},
+    {"fire",  bench_fire,  true},
+    {"pack",  bench_pack,  true},
+    {"remap", bench_remap, true},
+    {"alpha", bench_alpha, true},
+    {"add",   bench_add,   true},
+    {"max",   bench_max,   true},
+    {"wire",  bench_wire,  false},
+    {"hsv",   bench_hsv,   false},
+    {"oklch", bench_oklch, false},
+    {"wave",  bench_wave,  false},
+};
+
+static const lamp_fx_kernels_t *g_bench_kernels[] = {
+    &lamp_fx_ref,
+    &lamp_fx_fast,
+};
+
+/**< best of BENCH_ROUNDS, the minimum drops interrupts and cache misses */
+static uint32_t bench_cycles(bench_fn_t fn, const lamp_fx_kernels_t *kernels) {
+    uint32_t best = UINT32_MAX;
+
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        fn(kernels, round);
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        best = cycles < best ? cycles : best;
+    }
+    return best;
+}
+
+void board_bench_run(void) {
+    ESP_LOGI(TAG, "effect kernels, %d LEDs, %d MHz, best of %d",
+             BENCH_LEDS, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, BENCH_ROUNDS);
+    for (int i = 0; i < BENCH_LEDS; i++) {
+        g_bench_phys[i] = BENCH_LEDS - 1 - i;
+        g_bench_layer[i] = (lamp_rgb_t){i * 7, i * 3, 255 - i};
+    }
+    for (size_t c = 0; c < sizeof(g_bench_cases) / sizeof(g_bench_cases[0]); c++) {
+        size_t kernels = g_bench_cases[c].kernels ? sizeof(g_bench_kernels) / sizeof(g_bench_kernels[0]) : 1;
+        for (size_t k = 0; k < kernels; k++) {
+            memset(g_bench_buf, 0, sizeof(g_bench_buf));
+            uint32_t cycles = bench_cycles(g_bench_cases[c].fn, g_bench_kernels[k]);
+            uint32_t us = cycles / CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+            ESP_LOGI(TAG, "  %-6s %-5s %8"PRIu32" cycles, %6"PRIu32" us, %5"PRIu32" fps max",
+                     g_bench_cases[c].name, g_bench_cases[c].kernels ? g_bench_kernels[k]->name : "",
+                     cycles, us, us ? 1000000 / us : 0);
+        }
+    }
+    bench_anim();
+    bench_compose();
+}
+
+#else
+
+void board_bench_run(void) {
+    ESP_LOGD(TAG, "benchmarks disabled");
+}
+
+#endif /* CONFIG_LAMP_FX_BENCH */
@@ -0,0 +1,32 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 16:40:12
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 16:40:15
+ * @FilePath    : /shellhome-nightlamp/main/board_bench.h
+ * @Description : cycle counted benchmarks of the effect kernels
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef BOARD_BENCH_H
+#define BOARD_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+
+// run all benchmarks and log cycles per frame
+void board_bench_run(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* BOARD_BENCH_H */
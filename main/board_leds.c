@@ -10,6 +10,8 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
+#include <stdio.h>
 #include <sys/cdefs.h>
 
 #include "esp_err.h"
@@ -19,11 +21,27 @@
 #include "esp_attr.h"
 #include "driver/ledc.h"
 
-#include "led_strip.h"
+#include "board_mem.h"
+#include "board_pm.h"
 #include "board_leds.h"
 #include "board_sensor.h"
+#include "board_trace.h"
+#include "board_sync.h"
+#include "board_strip.h"
+#include "board_stats.h"
+#include "board_telemetry.h"
+#include "lamp_state.h"
+#include "lamp_render.h"
+#include "lamp_ctrl.h"
+#include "lamp_record.h"
+#include "lamp_layout.h"
+#include "lamp_latency.h"
+#include "lamp_compose.h"
+#include "lamp_tier.h"
 
 extern EventGroupHandle_t g_event_group;
+/**< probes stamped by board_sensor, closed by the renderer */
+lamp_latency_t g_latency;
 
 
 static const char *TAG = "LEDS";
@@ -34,19 +52,15 @@ static const char *TAG = "LEDS";
 */
 typedef struct led_rgb_s led_rgb_t;
 
-typedef enum {
-    LAMP_MODE_MARQUEE,
-    LAMP_MODE_BREATH,
-    LAMP_MODE_STACK,
-    LAMP_MODE_FIXED,
-    LAMP_MODE_BUTT
-} LAMP_MODE_ENUM;
-
-#define LAMP_MODE_MASK ((1<<2)-1)
-
 #define SAVE_TIMER_MS (3*60*1000)
 #define OFF_TIMER_MS (30*60*1000)
 
+/* warm white flash of a vibration hit, weight at the hit */
+#define OVERLAY_KICK_R      255
+#define OVERLAY_KICK_G      180
+#define OVERLAY_KICK_B      120
+#define OVERLAY_KICK_ALPHA  96
+
 /**
 * @brief Declare of LED rgb Type
 *
@@ -185,54 +199,44 @@ typedef struct {
 
 typedef struct {
     led_rgb_t *              top_led;
-    led_strip_handle_t     led_strip;
     nvs_handle_t          nvs_handle;
     esp_timer_handle_t    save_timer;
     esp_timer_handle_t     off_timer;
-    uint32_t                   index;
-    uint32_t                   count;
-    LAMP_MODE_ENUM         lamp_mode;
-    uint8_t                increased;
-    uint16_t                     hue;
-    uint8_t               saturation;
-    uint8_t                    value;
+    lamp_params_t             params;   /*!< owned by leds_task */
+    lamp_state_t               state;   /*!< published to the renderer */
+    TaskHandle_t         render_task;   /*!< runs leds_flush(), woken on changes */
+    TaskHandle_t          store_task;   /*!< runs the NVS writes of the save timer */
 } lamp_light_t;
 
 static lamp_light_t g_lamp;
-
-/**
- * @brief sin() function from 0 to 2π, in total 255 values rounded up，maximum 255，minimum 0
- *
- */
-/*
-static uint8_t  const SinValue[256]={	128,   131,   134,   137,   140,   143,   147,   150,   153,   156,
-                                159,   162,   165,   168,   171,   174,   177,   180,   182,   185,
-                                188,   191,   194,   196,   199,   201,   204,   206,   209,   211,
-                                214,   216,   218,   220,   223,   225,   227,   229,   230,   232,
-                                234,   236,   237,   239,   240,   242,   243,   245,   246,   247,
-                                248,   249,   250,   251,   252,   252,   253,   253,   254,   254,
-                                255,   255,   255,   255,   255,   255,   255,   255,   255,   254,
-                                254,   253,   253,   252,   251,   250,   249,   249,   247,   246,
-                                245,   244,   243,   241,   240,   238,   237,   235,   233,   231,
-                                229,   228,   226,   224,   221,   219,   217,   215,   212,   210,
-                                208,   205,   203,   200,   198,   195,   192,   189,   187,   184,
-                                181,   178,   175,   172,   169,   166,   163,   160,   157,   154,
-                                151,   148,   145,   142,   139,   136,   132,   129,   126,   123,
-                                120,   117,   114,   111,   107,   104,   101,    98,    95,    92,
-                                89,    86,    83,    80,    77,    74,    72,    69,    66,    63,
-                                61,    58,    55,    53,    50,    48,    45,    43,    41,    38,
-                                36,    34,    32,    30,    28,    26,    24,    22,    21,    19,
-                                17,    16,    14,    13,    12,    10,     9,     8,     7,     6,
-                                5,     4,     4,     3,     2,     2,     1,     1,     1,     0,
-                                0,     0,     0,     0,     1,     1,     1,     2,     2,     3,
-                                3,     4,     5,     6,     6,     7,     9,    10,    11,    12,
-                                14,    15,    17,    18,    20,    21,    23,    25,    27,    29,
-                                31,    33,    35,    37,    40,    42,    44,    47,    49,    52,
-                                54,    57,    59,    62,    65,    67,    70,    73,    76,    79,
-                                82,    85,    88,    91,    94,    97,   100,   103,   106,   109,
-                                112,   115,   118,   121,   125,   128
-};
-*/
+/**< renderer state, only touched by leds_flush() */
+static lamp_render_t g_render;
+/**< last frame sent, a wake up rendering the same frame sends nothing */
+static lamp_frame_t g_shown;
+static bool g_shown_valid = false;
+#ifdef CONFIG_LAMP_OVERLAY_KICK
+/**< the effect below, overlays above it, only touched by leds_flush() */
+static lamp_compose_t g_compose;
+static lamp_frame_t g_kick_flash;
+#endif
+#ifdef CONFIG_LAMP_TIER
+/**< fed with battery samples by leds_task */
+static lamp_tier_t g_tier;
+/**< level the renderer applies, published by leds_task */
+static uint8_t g_tier_level = LAMP_TIER_FULL;
+#endif
+/**< set by leds_record_dump(), the renderer restarts and the capture re-arms */
+static bool g_record_rearm = false;
+
+#define LEDS_TASK_STACK     (4 * 1024)
+MEM_TASK_DEFINE(leds, LEDS_TASK_STACK);
+/**< NVS commits erase and write flash, they run at the lowest priority */
+#define STORE_TASK_STACK    (3 * 1024)
+MEM_TASK_DEFINE(store, STORE_TASK_STACK);
+
+#ifdef CONFIG_LAMP_STATIC_ALLOC
+static led_pwm_t g_led_pwm;
+#endif
 
 static const uint8_t LEDGammaTable[] = {
     0,   0,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
@@ -254,63 +258,6 @@ static const uint8_t LEDGammaTable[] = {
 };
 
 
-/**
- * @brief Simple helper function, converting HSV color space to RGB color space
- *
- * Wiki: https://en.wikipedia.org/wiki/HSL_and_HSV
- *
- */
-static void led_hsv2rgb(uint32_t h, uint32_t s, uint32_t v, uint32_t *r, uint32_t *g, uint32_t *b)
-{
-    h %= 360; /**< h -> [0,360] */
-    uint32_t rgb_max = v * 2.55f;
-    uint32_t rgb_min = rgb_max * (100 - s) / 100.0f;
-
-    uint32_t i = h / 60;
-    uint32_t diff = h % 60;
-
-    /**< RGB adjustment amount by hue */
-    uint32_t rgb_adj = (rgb_max - rgb_min) * diff / 60;
-
-    switch (i) {
-        case 0:
-            *r = rgb_max;
-            *g = rgb_min + rgb_adj;
-            *b = rgb_min;
-            break;
-
-        case 1:
-            *r = rgb_max - rgb_adj;
-            *g = rgb_max;
-            *b = rgb_min;
-            break;
-
-        case 2:
-            *r = rgb_min;
-            *g = rgb_max;
-            *b = rgb_min + rgb_adj;
-            break;
-
-        case 3:
-            *r = rgb_min;
-            *g = rgb_max - rgb_adj;
-            *b = rgb_max;
-            break;
-
-        case 4:
-            *r = rgb_min + rgb_adj;
-            *g = rgb_min;
-            *b = rgb_max;
-            break;
-
-        default:
-            *r = rgb_max;
-            *g = rgb_min;
-            *b = rgb_max - rgb_adj;
-            break;
-    }
-}
-
 static esp_err_t led_set_rgb(led_rgb_t *led_rgb, uint32_t red,
                              uint32_t green, uint32_t blue) {
     led_pwm_t *led_pwm = __containerof(led_rgb, led_pwm_t, parent);
@@ -354,7 +301,11 @@ static esp_err_t led_get_rgb(led_rgb_t *led_rgb, uint8_t *red,
 
 static esp_err_t led_del(led_rgb_t *led_rgb) {
     led_pwm_t *led_pwm = __containerof(led_rgb, led_pwm_t, parent);
+#ifdef CONFIG_LAMP_STATIC_ALLOC
+    memset(led_pwm, 0, sizeof(led_pwm_t));
+#else
     free(led_pwm);
+#endif
     return ESP_OK;
 }
 
@@ -382,7 +333,11 @@ static led_rgb_t *led_rgb_create(const led_rgb_config_t *cfg) {
         .freq_hz         = cfg->freq,           /**< frequency of PWM signal */
         .speed_mode      = cfg->speed_mode,     /**< timer mode */
         .timer_num       = cfg->timer_sel,      /**< timer index */
+#ifdef CONFIG_PM_ENABLE
+        .clk_cfg         = LEDC_USE_RC_FAST_CLK, /**< APB changes with DFS */
+#else
         .clk_cfg         = LEDC_USE_APB_CLK,    /**< Auto select the source clock */
+#endif
     };
     /**< Set configuration of timer for low speed channels */
     LED_RGB_CHECK(ledc_timer_config(&ledc_timer) == ESP_OK,
@@ -412,8 +367,15 @@ static led_rgb_t *led_rgb_create(const led_rgb_config_t *cfg) {
                   "ledc channel config failed", err, NULL);
 
     /**< alloc memory for led */
+#ifdef CONFIG_LAMP_STATIC_ALLOC
+    led_pwm_t *led_pwm = &g_led_pwm;
+    memset(led_pwm, 0, sizeof(led_pwm_t));
+    mem_budget_add("top_led", sizeof(led_pwm_t), true);
+#else
     led_pwm_t *led_pwm = calloc(1, sizeof(led_pwm_t));
     LED_RGB_CHECK(led_pwm, "request memory for led failed", err, NULL);
+    mem_budget_add("top_led", sizeof(led_pwm_t), false);
+#endif
 
     for (size_t i = 0; i < 3; i++) {
         led_pwm->speed_mode[i] = ledc_channel.speed_mode;
@@ -437,109 +399,191 @@ err:
 
 
 /**
- * @brief Set RGB for all
+ * @brief Send a frame to the top LED and the strip
  *
  * @return
- *      - ESP_OK: Set RGB for a specific pixel successfully
- *      - ESP_ERR_INVALID_ARG: Set RGB for a specific pixel failed because of invalid parameters
- *      - ESP_FAIL: Set RGB for a specific pixel failed because other error occurred
+ *      - ESP_OK: Send frame successfully
+ *      - ESP_FAIL: Send frame failed because other error occurred
  */
-static esp_err_t all_set(uint8_t red, uint8_t green, uint8_t blue) {
-    ESP_ERROR_CHECK(led_set_rgb(g_lamp.top_led, red, green, blue));
-    for (int i = 0; i < CONFIG_STRIP_LED_NUM; i++) {
-        ESP_ERROR_CHECK(led_strip_set_pixel(g_lamp.led_strip, i,
-                                red, green, blue));
-    }
-    /* Refresh the strip to send data */
-    ESP_ERROR_CHECK(led_strip_refresh(g_lamp.led_strip));
+static esp_err_t all_show(const lamp_frame_t *frame) {
+    // LEDC stops in light sleep, the strip latches its last frame
+    board_pm_keep_awake(frame->top.r || frame->top.g || frame->top.b);
+    ESP_ERROR_CHECK(led_set_rgb(g_lamp.top_led, frame->top.r,
+                                frame->top.g, frame->top.b));
+    // the encoder walks the frame in wiring order as it sends
+    ESP_ERROR_CHECK(board_strip_show(frame->strip, lamp_layout()));
     return ESP_OK;
 }
 
-/**
- * @description : Clear LED
- */
-static esp_err_t all_clear(void) {
-    ESP_ERROR_CHECK(led_clear(g_lamp.top_led));
-    return led_strip_clear(g_lamp.led_strip);
-}
-
-static void random_color(void) {
-    /**< Set a random color */
-    g_lamp.hue = esp_random() / 11930465;
-    g_lamp.saturation = esp_random() / 42949673;
-    g_lamp.saturation = g_lamp.saturation < 40 ? 40 : (g_lamp.saturation > 100 ? 100 :g_lamp.saturation);
-    g_lamp.value = 100;
+static void random_color(uint16_t *hue, uint8_t *saturation) {
+    /**< Draw a random color */
+    uint32_t sat = esp_random() / 42949673;
+    *hue = esp_random() / 11930465;
+    *saturation = sat < 40 ? 40 : (sat > 100 ? 100 : sat);
 }
 
-static esp_err_t save_mod_to_nvs(void) {
-    esp_err_t err = nvs_set_u8(g_lamp.nvs_handle, "lamp-mode",
-                            (uint8_t)g_lamp.lamp_mode);
+/**
+ * @brief Persisted lamp state, read and written as one NVS blob so boot
+ *        needs a single lookup instead of one per field
+ *
+ */
+typedef struct {
+    uint8_t        lamp_mode;
+    uint8_t       saturation;
+    uint8_t            value;
+    uint8_t         reserved;
+    uint16_t             hue;
+} lamp_nvs_state_t;
+
+#define LAMP_NVS_STATE_KEY  "lamp-state"
+
+static esp_err_t save_state_to_nvs(void) {
+    lamp_params_t params;
+    lamp_state_snapshot(&g_lamp.state, &params);
+
+    lamp_nvs_state_t state = {
+        .lamp_mode  = params.lamp_mode,
+        .saturation = params.saturation,
+        .value      = params.value,
+        .hue        = params.hue,
+    };
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = nvs_set_blob(g_lamp.nvs_handle, LAMP_NVS_STATE_KEY,
+                                 &state, sizeof(state));
     ESP_ERROR_CHECK(err);
-    ESP_LOGI(TAG, "Save mode");
-    return nvs_commit(g_lamp.nvs_handle);
+    err = nvs_commit(g_lamp.nvs_handle);
+    TRACE(TRACE_SAVE_STATE, err, esp_timer_get_time() - start_us);
+    return err;
 }
 
 static esp_err_t load_mod_from_nvs(void) {
-    esp_err_t err = nvs_get_u8(g_lamp.nvs_handle, "lamp-mode",
-                            (uint8_t *)&g_lamp.lamp_mode);
+    uint8_t mode = LAMP_MODE_MARQUEE;
+    esp_err_t err = nvs_get_u8(g_lamp.nvs_handle, "lamp-mode", &mode);
     if (ESP_ERR_NVS_NOT_FOUND == err) {
-        // set default and save
-        g_lamp.lamp_mode = LAMP_MODE_MARQUEE;
-        err = save_mod_to_nvs();
+        // set default
+        mode = LAMP_MODE_MARQUEE;
+        err = ESP_OK;
     }
+    g_lamp.params.lamp_mode = mode;
     ESP_LOGI(TAG, "Load mode");
     return err;
 }
 
-static esp_err_t save_hvs_to_nvs(void) {
-    esp_err_t err = nvs_set_u16(g_lamp.nvs_handle, "lamp-h", g_lamp.hue);
-    ESP_ERROR_CHECK(err);
-    err = nvs_set_u8(g_lamp.nvs_handle, "lamp-s", g_lamp.saturation);
-    ESP_ERROR_CHECK(err);
-    err = nvs_set_u8(g_lamp.nvs_handle, "lamp-v", g_lamp.value);
-    ESP_ERROR_CHECK(err);
-    ESP_LOGI(TAG, "Save mode");
-    return nvs_commit(g_lamp.nvs_handle);
-}
-
 static esp_err_t load_hvs_from_nvs(void) {
-    bool changed = pdFALSE;
-
     esp_err_t err = nvs_get_u16(g_lamp.nvs_handle, "lamp-h",
-                            &g_lamp.hue);
+                            &g_lamp.params.hue);
     if (ESP_ERR_NVS_NOT_FOUND == err) {
-        // set default and save
-        random_color();
-        changed = pdTRUE;
+        // set default
+        random_color(&g_lamp.params.hue, &g_lamp.params.saturation);
+        g_lamp.params.value = 100;
         err = ESP_OK;
     }
     ESP_ERROR_CHECK(err);
     err = nvs_get_u8(g_lamp.nvs_handle, "lamp-s",
-                            &g_lamp.saturation);
+                            &g_lamp.params.saturation);
     if (ESP_ERR_NVS_NOT_FOUND == err) {
-        // set default and save
-        g_lamp.saturation = 100;
+        // set default
+        g_lamp.params.saturation = 100;
         err = ESP_OK;
-        changed = pdTRUE;
     }
     ESP_ERROR_CHECK(err);
     err = nvs_get_u8(g_lamp.nvs_handle, "lamp-v",
-                            &g_lamp.value);
+                            &g_lamp.params.value);
     if (ESP_ERR_NVS_NOT_FOUND == err) {
-        // set default and save
-        g_lamp.value = 100;
+        // set default
+        g_lamp.params.value = 100;
         err = ESP_OK;
-        changed = pdTRUE;
     }
-
-    if (changed) err = save_hvs_to_nvs();   // save change
     ESP_LOGI(TAG, "Load hsv");
     return err;
 }
 
+static esp_err_t load_state_from_nvs(void) {
+    lamp_nvs_state_t state;
+    size_t len = sizeof(state);
+
+    esp_err_t err = nvs_get_blob(g_lamp.nvs_handle, LAMP_NVS_STATE_KEY,
+                                 &state, &len);
+    if (ESP_OK == err && sizeof(state) == len) {
+        g_lamp.params.lamp_mode = state.lamp_mode;
+        g_lamp.params.saturation = state.saturation;
+        g_lamp.params.value = state.value;
+        g_lamp.params.hue = state.hue;
+        ESP_LOGI(TAG, "Load state");
+        return ESP_OK;
+    }
+
+    // fall back to the per-field keys of older firmware and migrate them
+    err = load_mod_from_nvs();
+    ESP_ERROR_CHECK(err);
+    err = load_hvs_from_nvs();
+    ESP_ERROR_CHECK(err);
+    lamp_state_publish(&g_lamp.state, &g_lamp.params);
+    return save_state_to_nvs();
+}
+
+#define LAMP_NVS_LAYOUT_KEY "lamp-layout"
+#ifdef CONFIG_LAMP_STATIC_ALLOC
+static uint8_t g_layout_blob[LAMP_LAYOUT_BLOB_MAX];
+#endif
+
+/**
+ * @brief Load the LED layout written by tools/layout_gen.py, a straight
+ *        line of all CONFIG_STRIP_LED_NUM LEDs when none or a bad one
+ *
+ */
+static void load_layout_from_nvs(void) {
+    lamp_layout_config_t *cfg = lamp_layout_config();
+    size_t len = LAMP_LAYOUT_BLOB_MAX;
+    esp_err_t err = ESP_ERR_NO_MEM;
+
+#ifdef CONFIG_LAMP_STATIC_ALLOC
+    uint8_t *blob = g_layout_blob;
+    mem_budget_add("layout blob", sizeof(g_layout_blob), true);
+#else
+    // only needed while loading
+    uint8_t *blob = malloc(LAMP_LAYOUT_BLOB_MAX);
+#endif
+    if (NULL != blob) {
+        err = nvs_get_blob(g_lamp.nvs_handle, LAMP_NVS_LAYOUT_KEY, blob, &len);
+    }
+    if (ESP_OK == err && lamp_layout_parse(blob, len, cfg)) {
+        ESP_LOGI(TAG, "Load layout: %d LEDs in %d segments%s", cfg->num,
+                 cfg->seg_num, (cfg->flags & LAMP_LAYOUT_HAS_COORDS) ? " with coordinates" : "");
+    } else {
+        if (ESP_ERR_NVS_NOT_FOUND != err) {
+            ESP_LOGW(TAG, "bad layout (%s), using a line", esp_err_to_name(err));
+        }
+        lamp_layout_default(cfg, CONFIG_STRIP_LED_NUM);
+    }
+    lamp_layout_build(cfg);
+#ifndef CONFIG_LAMP_STATIC_ALLOC
+    free(blob);
+#endif
+}
+
+// records and frames share the clock of synchronized lamps
+static inline uint32_t leds_now_ms(void) {
+    return board_sync_now_ms();
+}
+
 static void save_timer_cb(void *args) {
-    save_mod_to_nvs();
-    save_hvs_to_nvs();
+    // flash work would stall every other esp_timer callback, hand it over
+    LAMP_RECORD(leds_now_ms(), LAMP_RECORD_TIMER, LAMP_RECORD_TIMER_SAVE, 0, 0);
+#ifdef CONFIG_LAMP_STORE_ON_TIMER
+    save_state_to_nvs();
+#else
+    xTaskNotifyGive(g_lamp.store_task);
+#endif
+}
+
+static void store_task(void *arg) {
+    ESP_LOGI(TAG, "store ...");
+    while (1) {
+        // saves requested while one is running collapse into one more
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        save_state_to_nvs();
+    }
 }
 
 static void reset_save_timer(void) {
@@ -552,17 +596,19 @@ static void reset_save_timer(void) {
         };
 
         esp_timer_create(&save_cnf, &g_lamp.save_timer);
-        esp_timer_start_once(g_lamp.save_timer, SAVE_TIMER_MS);
-        ESP_LOGI(TAG, "create save timer");
+        esp_timer_start_once(g_lamp.save_timer, SAVE_TIMER_MS * 1000ULL);
+        TRACE(TRACE_SAVE_TIMER, 1, 0);
     } else {
         // restart
-        esp_timer_restart(g_lamp.save_timer, SAVE_TIMER_MS);
-        ESP_LOGI(TAG, "restart save timer");
+        esp_timer_restart(g_lamp.save_timer, SAVE_TIMER_MS * 1000ULL);
+        TRACE(TRACE_SAVE_TIMER, 0, 0);
     }
 }
 
 static void off_timer_cb(void *args) {
-    all_clear();
+    // the renderer owns the drivers, only request the lamp off
+    LAMP_RECORD(leds_now_ms(), LAMP_RECORD_TIMER, LAMP_RECORD_TIMER_OFF, 0, 0);
+    xEventGroupSetBits(g_event_group, EVENT_OFF_BITS);
 }
 
 static void reset_off_timer(void) {
@@ -575,48 +621,135 @@ static void reset_off_timer(void) {
         };
 
         esp_timer_create(&off_cnf, &g_lamp.off_timer);
-        esp_timer_start_once(g_lamp.off_timer, OFF_TIMER_MS);
-        ESP_LOGI(TAG, "create off timer");
+        esp_timer_start_once(g_lamp.off_timer, OFF_TIMER_MS * 1000ULL);
+        TRACE(TRACE_OFF_TIMER, 1, 0);
     } else {
         // restart
-        esp_timer_restart(g_lamp.off_timer, OFF_TIMER_MS);
-        ESP_LOGI(TAG, "restart off timer");
+        esp_timer_restart(g_lamp.off_timer, OFF_TIMER_MS * 1000ULL);
+        TRACE(TRACE_OFF_TIMER, 0, 0);
     }
 }
 
+// wake the renderer, it may be blocked on a static frame
+static inline void leds_wake(void) {
+    if (NULL != g_lamp.render_task) {
+        xTaskNotifyGive(g_lamp.render_task);
+    }
+}
+
+/**
+ * @brief Record and apply one control event, then act on the result
+ *
+ */
+static void leds_ctrl(lamp_params_t *params, const lamp_ctrl_event_t *event) {
+    LAMP_RECORD(leds_now_ms(), LAMP_RECORD_CTRL, event->type,
+                event->hue, event->saturation);
+    uint32_t act = lamp_ctrl_apply(params, event);
+    TRACE(TRACE_CTRL, event->type, act);
+    if (act & LAMP_CTRL_ACT_REJECTED) {
+        ESP_LOGE(TAG, "can't change color at this mode");
+    }
+    if (act & LAMP_CTRL_ACT_PUBLISH) {
+        lamp_state_publish(&g_lamp.state, params);
+        LAMP_LATENCY_APPLIED(&g_latency, event->type, true);
+        leds_wake();
+        TRACE(TRACE_PARAMS, params->lamp_mode | (params->power << 8),
+              ((uint32_t)params->hue << 16) | (params->saturation << 8) | params->value);
+    } else {
+        LAMP_LATENCY_APPLIED(&g_latency, event->type, false);
+    }
+    if (act & LAMP_CTRL_ACT_SAVE_TIMER) {
+        reset_save_timer();
+    }
+    if (act & LAMP_CTRL_ACT_OFF_TIMER) {
+        reset_off_timer();
+    }
+}
+
+/**< close the probes of the events a wake up cleared but did not handle */
+static void leds_latency_discard(EventBits_t bits, uint8_t handled) {
+#ifdef CONFIG_LAMP_LATENCY
+    static const EventBits_t ctrl_bits[LAMP_CTRL_BUTT] = {
+        [LAMP_CTRL_MODE]  = EVENT_MODE_BITS,
+        [LAMP_CTRL_COLOR] = EVENT_COLOR_BITS,
+        [LAMP_CTRL_TIMER] = EVENT_TIMER_BITS,
+        [LAMP_CTRL_OFF]   = EVENT_OFF_BITS,
+    };
+    for (uint8_t type = 0; type < LAMP_CTRL_BUTT; type++) {
+        if (type != handled && (bits & ctrl_bits[type])) {
+            lamp_latency_applied(&g_latency, type, false);
+        }
+    }
+#endif
+}
+
+#ifdef CONFIG_LAMP_TIER
+/**< feed the latest battery sample, a new tier repaints at once */
+static void leds_tier_update(void) {
+    sensor_values_t values;
+
+    sensor_snapshot(&values);
+    uint8_t from = g_tier.level;
+    if (!lamp_tier_update(&g_tier, values.battery_mv, 0 != values.chrg_state, leds_now_ms())) {
+        return;
+    }
+    __atomic_store_n(&g_tier_level, g_tier.level, __ATOMIC_RELEASE);
+    leds_wake();
+    ESP_LOGI(TAG, "battery tier %s -> %s at %d%%, %"PRId32" mV%s", lamp_tier_name(from),
+             lamp_tier_name(g_tier.level), g_tier.soc, values.battery_mv,
+             values.chrg_state ? ", on the charger" : "");
+    TELEMETRY(TELEMETRY_TIER, g_tier.level, g_tier.soc, g_tier.changes, 0);
+}
+#endif
+
 static void leds_task(void *pvParameters) {
+    lamp_params_t *params = &g_lamp.params;
+
     ESP_LOGI(TAG, "svc ...");
     while (1) {
         EventBits_t bits = xEventGroupWaitBits(g_event_group,
-                                EVENT_MODE_BITS|EVENT_TIMER_BITS|EVENT_COLOR_BITS,
+                                EVENT_MODE_BITS|EVENT_TIMER_BITS|EVENT_COLOR_BITS|EVENT_OFF_BITS|
+                                EVENT_DUMP_BITS|EVENT_KICK_BITS|EVENT_BATTERY_BITS,
                                 pdTRUE, pdFAIL, portMAX_DELAY);
+        lamp_ctrl_event_t event = {0};
+        if (bits & EVENT_DUMP_BITS) {
+            leds_record_dump();
+            board_trace_dump();
+            leds_latency_report();
+            leds_tier_report();
+            board_stats_request();
+        }
+#ifdef CONFIG_LAMP_TIER
+        if (bits & EVENT_BATTERY_BITS) {
+            leds_tier_update();
+        }
+#endif
+        if (bits & EVENT_KICK_BITS) {
+            // hits are frequent, they skip the settle delay below
+            event.type = LAMP_CTRL_KICK;
+            leds_ctrl(params, &event);
+        }
+        bits &= ~(EVENT_DUMP_BITS|EVENT_KICK_BITS|EVENT_BATTERY_BITS);
+        if (0 == bits) {
+            continue;
+        }
+
         if (bits & EVENT_MODE_BITS) {
-            // change mode
-            g_lamp.lamp_mode += 1;
-            g_lamp.lamp_mode &= LAMP_MODE_MASK;
-            // reset counter, index, increased
-            g_lamp.count = CONFIG_STRIP_LED_NUM + 1; // LED at the top
-            g_lamp.increased = pdTRUE;
-            g_lamp.index = 0;
-            // reset save timer
-            reset_save_timer();
-            ESP_LOGI(TAG, "mode changed to %d", g_lamp.lamp_mode);
+            event.type = LAMP_CTRL_MODE;
         } else if (bits & EVENT_COLOR_BITS) {
-            // change color
-            if (LAMP_MODE_MARQUEE != g_lamp.lamp_mode) {
-                random_color();
-                // reset save timer
-                reset_save_timer();
-                ESP_LOGI(TAG, "next random");
-            } else {
-                ESP_LOGE(TAG, "can't change color at this mode");
-            }
+            // random draws stay outside the state machine so replay is exact
+            event.type = LAMP_CTRL_COLOR;
+            random_color(&event.hue, &event.saturation);
         } else if (bits & EVENT_TIMER_BITS) {
-            reset_off_timer();
-            ESP_LOGI(TAG, "Timer off reset");
+            event.type = LAMP_CTRL_TIMER;
+        } else if (bits & EVENT_OFF_BITS) {
+            event.type = LAMP_CTRL_OFF;
         } else {
             ESP_LOGE(TAG, "Unknown Bit set %d", (int)bits);
+            continue;
         }
+        leds_ctrl(params, &event);
+        leds_latency_discard(bits, event.type);
         vTaskDelay(1000/portTICK_PERIOD_MS);
     }
 
@@ -628,21 +761,48 @@ static void leds_task(void *pvParameters) {
 //  init leds
 esp_err_t leds_init(void) {
     memset(&g_lamp, 0, sizeof(g_lamp));
-    g_lamp.lamp_mode = LAMP_MODE_BUTT;
+    lamp_render_config_t render_cfg = {
+        .fade_ms = CONFIG_LAMP_FADE_MS,
+        .step_ms = CONFIG_LAMP_FADE_STEP_MS,
+    };
+    lamp_render_init(&g_render, &render_cfg);
+#ifdef CONFIG_LAMP_OVERLAY_KICK
+    lamp_compose_init(&g_compose, lamp_fx_kernels());
+    lamp_frame_fill(&g_kick_flash, OVERLAY_KICK_R, OVERLAY_KICK_G, OVERLAY_KICK_B);
+    mem_budget_add("compose", sizeof(g_compose) + sizeof(g_kick_flash), true);
+#endif
+    g_lamp.params.lamp_mode = LAMP_MODE_BUTT;
+    g_lamp.params.power = pdTRUE;
+    g_lamp.render_task = xTaskGetCurrentTaskHandle();
+    lamp_latency_init(&g_latency);
+#ifdef CONFIG_LAMP_TIER
+    lamp_tier_init(&g_tier, CONFIG_LAMP_TIER_DWELL_S * 1000);
+    mem_budget_add("tier", sizeof(g_tier), true);
+#endif
 
     ESP_LOGI(TAG, "init ...");
+    // the particle pools of the incoming and the outgoing effect on their own line
+    size_t particles = 2 * sizeof(lamp_particle_pool_t);
+    mem_budget_add("lamp", sizeof(g_lamp) + sizeof(g_render) - particles
+                   + sizeof(g_shown) + sizeof(g_latency), true);
+    mem_budget_add("particles", particles, true);
+#ifdef CONFIG_LAMP_RECORD
+    // the ring and the copy leds_record_dump() prints from
+    mem_budget_add("record", lamp_record_size() + CONFIG_LAMP_RECORD_NUM * sizeof(lamp_record_t)
+                   + LAMP_LAYOUT_BLOB_MAX, true);
+#endif
 
     // Open NVS
     esp_err_t err = nvs_open("ShellHome", NVS_READWRITE, &g_lamp.nvs_handle);
     ESP_ERROR_CHECK(err);
 
-    // load Mode
+    // load mode and hsv
     ESP_LOGI(TAG, "load ...");
-    err = load_mod_from_nvs();
-    ESP_ERROR_CHECK(err);
-    // load hsv
-    err = load_hvs_from_nvs();
+    err = load_state_from_nvs();
     ESP_ERROR_CHECK(err);
+    lamp_state_publish(&g_lamp.state, &g_lamp.params);
+    load_layout_from_nvs();
+    mem_budget_add("layout", sizeof(lamp_layout_t) + sizeof(lamp_layout_config_t), true);
 
     ESP_LOGI(TAG, "init top led");
     /**< configure top led driver */
@@ -655,85 +815,265 @@ esp_err_t leds_init(void) {
     }
 
     ESP_LOGI(TAG, "init led strip");
-    // LED strip general initialization
-    led_strip_config_t strip_config = {
-        .strip_gpio_num = CONFIG_STRIP_GPIO_NUM,       // The GPIO connected to the LED strip's data line
-        .max_leds = CONFIG_STRIP_LED_NUM,              // The number of LEDs in the strip,
-        .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,       // Pixel format of your LED strip
-        // .led_pixel_format = LED_PIXEL_FORMAT_GRB,       // Pixel format of your LED strip
-        .led_model = LED_MODEL_WS2812,                  // LED strip model
-        .flags.invert_out = false,                      // whether to invert the output signal
-    };
-
-    // LED strip backend configuration: RMT
-    led_strip_rmt_config_t rmt_config = {
-        .clk_src = RMT_CLK_SRC_DEFAULT,                 // different clock source can lead to different power consumption
-        .resolution_hz = CONFIG_LED_STRIP_RESOLUTION_HZ, // RMT counter clock frequency
-        .flags.with_dma = false,               // DMA feature is available on ESP target like ESP32-S3
-    };
-    ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config, &rmt_config,
-                                             &(g_lamp.led_strip)));
+    ESP_ERROR_CHECK(board_strip_init(CONFIG_STRIP_GPIO_NUM));
     return ESP_OK;
 }
 
 
 // start leds task
 esp_err_t leds_start(void) {
-    xTaskCreate(&leds_task, "leds_task", 4 * 1024, NULL, 2, NULL);
-    return ESP_OK;
+    // before leds_task, its events may start the save timer
+    g_lamp.store_task = MEM_TASK_CREATE(store, &store_task, "store_task",
+                                        STORE_TASK_STACK, NULL, 1);
+    if (NULL == g_lamp.store_task) {
+        return ESP_FAIL;
+    }
+    TaskHandle_t task = MEM_TASK_CREATE(leds, &leds_task, "leds_task",
+                                        LEDS_TASK_STACK, NULL, 2);
+    return NULL == task ? ESP_FAIL : ESP_OK;
+}
+
+static bool is_particle_mode(uint32_t mode) {
+    return LAMP_MODE_SPARKS == mode || LAMP_MODE_COMET == mode ||
+           LAMP_MODE_RAIN == mode;
+}
+
+/**
+ * @brief Log pool occupancy of the particle effect now shown, at the rate
+ *        of the power report
+ *
+ */
+static void leds_particle_report(uint32_t now_ms, uint32_t mode) {
+    static uint32_t report_ms = 0;
+
+    if (!is_particle_mode(mode) || now_ms - report_ms < CONFIG_LAMP_PM_REPORT_S * 1000) {
+        return;
+    }
+    report_ms = now_ms;
+    const lamp_particle_pool_t *pool = &lamp_render_effect(&g_render)->particles;
+    ESP_LOGI(TAG, "particles live %d/%d peak %d, spawned %"PRIu32" retired %"PRIu32" failed %"PRIu32,
+             pool->live, LAMP_PARTICLE_MAX, pool->stats.peak, pool->stats.spawned,
+             pool->stats.retired, pool->stats.failed);
+}
+
+#ifdef CONFIG_LAMP_OVERLAY_KICK
+/**
+ * @brief Add a fading flash over the effect on every vibration hit, the
+ *        particle effects turn hits into sparks themselves
+ *
+ * @return composite of the effect and the flash
+ */
+static const lamp_frame_t *leds_overlay(const lamp_frame_t *frame, const lamp_params_t *params,
+                                        uint32_t now_ms, uint32_t *interval) {
+    static uint8_t kick = 0;
+    static uint32_t flash_ms = 0;
+    static bool flashing = false;
+    uint32_t alpha = 0;
+
+    if (params->kick != kick) {
+        kick = params->kick;
+        flash_ms = now_ms;
+        flashing = params->power && !is_particle_mode(params->lamp_mode);
+    }
+    uint32_t elapsed = now_ms - flash_ms;
+    if (flashing && elapsed < CONFIG_LAMP_OVERLAY_KICK_MS) {
+        alpha = OVERLAY_KICK_ALPHA * (CONFIG_LAMP_OVERLAY_KICK_MS - elapsed) / CONFIG_LAMP_OVERLAY_KICK_MS;
+        // the frame after the end clears the flash
+        *interval = *interval < CONFIG_LAMP_FADE_STEP_MS ? *interval : CONFIG_LAMP_FADE_STEP_MS;
+    } else {
+        flashing = false;
+    }
+
+    // the effect covers the black below it, without a flash it is sent as is
+    lamp_compose_set(&g_compose, 0, frame, LAMP_BLEND_ALPHA, LAMP_BLEND_OPAQUE);
+    lamp_compose_touch(&g_compose, 0);
+    lamp_compose_set(&g_compose, 1, &g_kick_flash, LAMP_BLEND_ADD, alpha);
+    return lamp_compose_frame(&g_compose);
+}
+#endif
+
+/**
+ * @brief Render and send one frame of the current mode
+ *
+ * @return interval in ms until the next frame is due
+ */
+static uint32_t leds_render(void) {
+#ifdef CONFIG_LAMP_RECORD
+    /**< params and tier as last recorded, a record is added only when they change */
+    static lamp_params_t recorded;
+    static uint8_t recorded_tier = LAMP_TIER_FULL;
+    static bool recorded_valid = false;
+#endif
+    uint32_t interval = 0;
+    lamp_params_t params;
+#ifdef CONFIG_LAMP_TIER
+    uint8_t tier = __atomic_load_n(&g_tier_level, __ATOMIC_ACQUIRE);
+#else
+    uint8_t tier = LAMP_TIER_FULL;
+#endif
+
+    board_pm_frame_begin();
+
+    // one consistent snapshot per frame, it reflects every probe up to gen
+    uint32_t gen = lamp_latency_frame_begin(&g_latency);
+    lamp_state_snapshot(&g_lamp.state, &params);
+    uint32_t now_ms = leds_now_ms();
+
+#ifdef CONFIG_LAMP_RECORD
+    if (__atomic_exchange_n(&g_record_rearm, false, __ATOMIC_ACQUIRE)) {
+        // a capture must start from a fresh renderer to replay exactly
+        lamp_render_config_t cfg = g_render.cfg;
+        lamp_render_init(&g_render, &cfg);
+        recorded_valid = false;
+    }
+    if (!recorded_valid || tier != recorded_tier) {
+        LAMP_RECORD(now_ms, LAMP_RECORD_TIER, tier, 0, 0);
+        recorded_tier = tier;
+    }
+    if (!recorded_valid || 0 != memcmp(&recorded, &params, sizeof(params))) {
+        LAMP_RECORD(now_ms, LAMP_RECORD_PARAMS, params.lamp_mode, params.hue,
+                    lamp_record_pack_params(&params));
+        recorded = params;
+        recorded_valid = true;
+    }
+#endif
+    // the capture holds the params as set, replay applies the tier the same way
+    lamp_tier_params(tier, &params);
+
+    const lamp_frame_t *frame = lamp_render_frame(&g_render, &params,
+                                                  now_ms, &interval);
+    LAMP_RECORD(now_ms, LAMP_RECORD_FRAME, 0, 0, lamp_frame_checksum(frame));
+    if (params.power && params.lamp_mode >= LAMP_MODE_BUTT) {
+        ESP_LOGE(TAG, "unknow mode of lamp");
+    }
+#ifdef CONFIG_LAMP_OVERLAY_KICK
+    // overlays stay out of the capture, replay checks the effects alone
+    frame = leds_overlay(frame, &params, now_ms, &interval);
+#endif
+    interval = lamp_tier_interval(tier, interval);
+    if (!g_shown_valid || 0 != memcmp(&g_shown, frame, sizeof(lamp_frame_t))) {
+        all_show(frame);
+        memcpy(&g_shown, frame, sizeof(lamp_frame_t));
+        g_shown_valid = true;
+    }
+#ifdef CONFIG_LAMP_LATENCY
+    // the strip latches once the transmission is done
+    lamp_latency_frame_commit(&g_latency, gen, esp_timer_get_time());
+#else
+    (void)gen;
+#endif
+
+    board_pm_frame_end(params.power ? params.lamp_mode : LAMP_MODE_BUTT);
+    leds_particle_report(now_ms, params.power ? params.lamp_mode : LAMP_MODE_BUTT);
+    return interval;
+}
+
+// show the first frame of the current mode
+void leds_show(void) {
+    leds_render();
 }
 
 // flush leds
 void leds_flush(void) {
+    uint32_t interval = leds_render();
 
-    uint32_t r, g, b;
-
-    if (LAMP_MODE_FIXED == g_lamp.lamp_mode) {
-        led_hsv2rgb((uint32_t)g_lamp.hue, (uint32_t)g_lamp.saturation,
-                    (uint32_t)g_lamp.value,
-                    &r, &g, &b);
-        all_set((uint8_t)r, (uint8_t)g, (uint8_t)b);
-        vTaskDelay(pdMS_TO_TICKS(100));
-    } else if (LAMP_MODE_BREATH == g_lamp.lamp_mode) {
-        led_hsv2rgb((uint32_t)g_lamp.hue, 100,
-                    (uint32_t)g_lamp.value,
-                    &r, &g, &b);
-        all_set((uint8_t)r, (uint8_t)g, (uint8_t)b);
-        if (g_lamp.increased) {
-            g_lamp.increased = ((g_lamp.value++) >= 99) ? pdFALSE : pdTRUE;
-        } else {
-            g_lamp.increased = ((g_lamp.value--) < 15) ? pdTRUE : pdFALSE;
+    // a static frame sleeps until the state changes, others until due or
+    // woken; round up, a wait of 0 ticks would spin until the frame is due
+    ulTaskNotifyTake(pdTRUE, LAMP_RENDER_IDLE == interval ? portMAX_DELAY
+                     : (interval + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
+}
+
+// dump the captured records and start a new capture
+void leds_record_dump(void) {
+#ifdef CONFIG_LAMP_RECORD
+    static lamp_record_t records[CONFIG_LAMP_RECORD_NUM];
+    static uint8_t blob[LAMP_LAYOUT_BLOB_MAX];
+    bool wrapped = false;
+
+    size_t num = lamp_record_copy(records, CONFIG_LAMP_RECORD_NUM, &wrapped);
+    ESP_LOGI(TAG, "record dump: %d records%s", (int)num,
+             wrapped ? ", wrapped, replay starts mid-capture" : "");
+    // what tools/record_replay.c must be built with to render the same frames
+#ifdef CONFIG_LAMP_COLOR_OKLCH
+    const int oklch = 1;
+#else
+    const int oklch = 0;
+#endif
+    printf("REC-CFG leds %d oklch %d kernels %s fade %"PRIu32" step %"PRIu32"\n",
+           LAMP_STRIP_MAX, oklch, lamp_fx_kernels()->name, g_render.cfg.fade_ms,
+           g_render.cfg.step_ms);
+    size_t len = lamp_layout_pack(lamp_layout_config(), blob);
+    for (size_t at = 0; at < len; at += 32) {
+        // offset and up to 32 bytes of the layout blob
+        printf("REC-LAYOUT %04x ", (unsigned)at);
+        for (size_t i = at; i < len && i < at + 32; i++) {
+            printf("%02x", blob[i]);
         }
-        vTaskDelay(pdMS_TO_TICKS(20));
-    } else if (LAMP_MODE_MARQUEE == g_lamp.lamp_mode) {
-        for (int i = 0; i < CONFIG_STRIP_LED_NUM; i++) {
-            led_hsv2rgb((uint32_t)g_lamp.hue+i, 100, 100,
-                        &r, &g, &b);
-            if (0 == i) led_set_rgb(g_lamp.top_led, r, g, b);
-            led_strip_set_pixel(g_lamp.led_strip, i, r, g, b);
+        printf("\n");
+    }
+    for (size_t i = 0; i < num; i++) {
+        const lamp_record_t *rec = &records[i];
+        // one line per record: ts type a b c, all hex
+        printf("REC %08"PRIx32" %02x %02x %04x %08"PRIx32"\n", rec->ts_ms,
+               rec->type, rec->a, rec->b, rec->c);
+    }
+    ESP_LOGI(TAG, "record dump end");
+
+    lamp_record_clear();
+    __atomic_store_n(&g_record_rearm, true, __ATOMIC_RELEASE);
+    leds_wake();
+#else
+    ESP_LOGW(TAG, "recorder disabled");
+#endif
+}
+
+// log the latency histograms since boot
+void leds_latency_report(void) {
+#ifdef CONFIG_LAMP_LATENCY
+    char line[LAMP_LATENCY_BINS * 11 + 1];    /*!< " %u" per bin */
+
+    ESP_LOGI(TAG, "input to photon latency:");
+    for (uint8_t i = 0; i < LAMP_LATENCY_SOURCE_NUM; i++) {
+        // a racy copy, the renderer may add a sample meanwhile
+        lamp_latency_hist_t hist = g_latency.hist[i];
+        if (0 == hist.count) {
+            ESP_LOGI(TAG, "  %-8s no samples, %"PRIu32" dropped",
+                     lamp_latency_source_name(i), hist.dropped);
+            continue;
         }
-        /* Refresh the strip to send data */
-        led_strip_refresh(g_lamp.led_strip);
-
-        // increase hue for next time
-        g_lamp.hue++;
-        g_lamp.hue = g_lamp.hue > 360 ? 0 : g_lamp.hue;
-
-        vTaskDelay(pdMS_TO_TICKS(30));
-    } else if (LAMP_MODE_STACK == g_lamp.lamp_mode) {
-        // clear for all
-        all_clear();
-        if (0 == g_lamp.index) {
-            led_set_rgb(g_lamp.top_led, r, g, b);
-        } else {
-            led_strip_set_pixel(g_lamp.led_strip, g_lamp.index-1, r, g, b);
+        ESP_LOGI(TAG, "  %-8s %"PRIu32" samples, min %"PRIu32" avg %"PRIu32" max %"PRIu32
+                 " us, p50 < %"PRIu32" p99 < %"PRIu32" ms, %"PRIu32" dropped",
+                 lamp_latency_source_name(i), hist.count, hist.min_us,
+                 (uint32_t)(hist.sum_us / hist.count), hist.max_us,
+                 lamp_latency_percentile(&hist, 50) / 1000,
+                 lamp_latency_percentile(&hist, 99) / 1000, hist.dropped);
+        // one count per bin, bin k from 2^(k-1) ms
+        int len = 0;
+        for (uint32_t bin = 0; bin < LAMP_LATENCY_BINS; bin++) {
+            len += snprintf(line + len, sizeof(line) - len, " %"PRIu32, hist.bins[bin]);
         }
-        /* Refresh the strip to send data */
-        led_strip_refresh(g_lamp.led_strip);
-        g_lamp.index++;
-        g_lamp.index = g_lamp.index >= CONFIG_STRIP_LED_NUM ? 0 : g_lamp.index;
-        vTaskDelay(pdMS_TO_TICKS(100));
-    } else {
-        ESP_LOGE(TAG, "unknow mode of lamp");
+        ESP_LOGI(TAG, "  %-8s bins%s", "", line);
+    }
+#else
+    ESP_LOGW(TAG, "latency probes disabled");
+#endif
+}
+
+// log the time spent in every battery tier since boot
+void leds_tier_report(void) {
+#ifdef CONFIG_LAMP_TIER
+    // called by leds_task, the owner of the tier
+    lamp_tier_update(&g_tier, 0, false, leds_now_ms());
+    ESP_LOGI(TAG, "battery tier %s at %d%%, %"PRIu32" changes, time in each tier:",
+             lamp_tier_name(g_tier.level), g_tier.soc, g_tier.changes);
+    for (uint8_t i = 0; i < LAMP_TIER_BUTT; i++) {
+        const lamp_tier_policy_t *policy = lamp_tier_policy(i);
+        uint32_t s = (uint32_t)(g_tier.time_ms[i] / 1000);
+        ESP_LOGI(TAG, "  %-8s %5"PRIu32":%02"PRIu32":%02"PRIu32"  value <= %d, frames >= %d ms",
+                 lamp_tier_name(i), s / 3600, s / 60 % 60, s % 60,
+                 policy->value_max, policy->frame_ms);
     }
+#else
+    ESP_LOGW(TAG, "battery tiers disabled");
+#endif
 }
@@ -38,9 +38,22 @@ esp_err_t leds_init(void);
 // start leds task
 esp_err_t leds_start(void);
 
-// flush leds
+// show the first frame of the current mode
+void leds_show(void);
+
+// render one frame and sleep until the next is due, a static frame sleeps
+// until the state changes; call from the task that ran leds_init()
 void leds_flush(void);
 
+// dump the captured records and start a new capture
+void leds_record_dump(void);
+
+// log the input to photon latency histograms since boot
+void leds_latency_report(void);
+
+// log the time spent in every battery tier since boot
+void leds_tier_report(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,140 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 09:12:52
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 09:12:55
+ * @FilePath    : /shellhome-nightlamp/main/board_mem.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#include "board_mem.h"
+
+static const char *TAG = "MEM";
+
+/**< every entry of a full build with room to spare, a dropped one is logged */
+#define MEM_BUDGET_MAX  40
+
+typedef struct {
+    const char *     tag;
+    size_t          size;
+    bool       is_static;
+} mem_budget_t;
+
+static mem_budget_t g_budget[MEM_BUDGET_MAX];
+static uint32_t g_budget_num = 0;
+static uint32_t g_budget_dropped = 0;
+static portMUX_TYPE g_budget_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void mem_budget_add(const char *tag, size_t size, bool is_static) {
+    bool dropped = false;
+
+    portENTER_CRITICAL(&g_budget_lock);
+    if (g_budget_num < MEM_BUDGET_MAX) {
+        g_budget[g_budget_num].tag = tag;
+        g_budget[g_budget_num].size = size;
+        g_budget[g_budget_num].is_static = is_static;
+        g_budget_num++;
+    } else {
+        g_budget_dropped++;
+        dropped = true;
+    }
+    portEXIT_CRITICAL(&g_budget_lock);
+    if (dropped) {
+        ESP_LOGE(TAG, "RAM budget full, %s (%u bytes) not recorded, raise MEM_BUDGET_MAX",
+                 tag, (unsigned)size);
+    }
+}
+
+void mem_budget_report(void) {
+    size_t total_static = 0;
+    size_t total_heap = 0;
+
+    ESP_LOGI(TAG, "RAM budget (%s allocation):",
+#ifdef CONFIG_LAMP_STATIC_ALLOC
+             "static"
+#else
+             "heap"
+#endif
+             );
+    for (uint32_t i = 0; i < g_budget_num; i++) {
+        ESP_LOGI(TAG, "  %-16s %6u bytes %s", g_budget[i].tag,
+                 (unsigned)g_budget[i].size,
+                 g_budget[i].is_static ? "static" : "heap");
+        if (g_budget[i].is_static) {
+            total_static += g_budget[i].size;
+        } else {
+            total_heap += g_budget[i].size;
+        }
+    }
+    ESP_LOGI(TAG, "  total static %u bytes, heap %u bytes",
+             (unsigned)total_static, (unsigned)total_heap);
+    if (g_budget_dropped) {
+        ESP_LOGE(TAG, "  %u entries dropped, the totals are short",
+                 (unsigned)g_budget_dropped);
+    }
+    ESP_LOGI(TAG, "  heap free %u, minimum free %u, largest block %u",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+             (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+}
+
+TaskHandle_t mem_task_create(TaskFunction_t fn, const char *tag,
+                             uint32_t stack_size, void *arg, UBaseType_t prio) {
+    TaskHandle_t handle = NULL;
+    if (pdPASS != xTaskCreate(fn, tag, stack_size, arg, prio, &handle)) {
+        ESP_LOGE(TAG, "create task %s failed", tag);
+        return NULL;
+    }
+    mem_budget_add(tag, stack_size + sizeof(StaticTask_t), false);
+    return handle;
+}
+
+QueueHandle_t mem_queue_create(const char *tag, UBaseType_t length,
+                               UBaseType_t item_size) {
+    QueueHandle_t handle = xQueueCreate(length, item_size);
+    if (NULL == handle) {
+        ESP_LOGE(TAG, "create queue %s failed", tag);
+        return NULL;
+    }
+    mem_budget_add(tag, length * item_size + sizeof(StaticQueue_t), false);
+    return handle;
+}
+
+EventGroupHandle_t mem_event_group_create(const char *tag) {
+    EventGroupHandle_t handle = xEventGroupCreate();
+    if (NULL == handle) {
+        ESP_LOGE(TAG, "create event group %s failed", tag);
+        return NULL;
+    }
+    mem_budget_add(tag, sizeof(StaticEventGroup_t), false);
+    return handle;
+}
+
+TaskHandle_t mem_task_create_static(TaskFunction_t fn, const char *tag,
+                                    uint32_t stack_size, void *arg,
+                                    UBaseType_t prio, StackType_t *stack,
+                                    StaticTask_t *tcb) {
+    mem_budget_add(tag, stack_size * sizeof(StackType_t) + sizeof(StaticTask_t), true);
+    return xTaskCreateStatic(fn, tag, stack_size, arg, prio, stack, tcb);
+}
+
+QueueHandle_t mem_queue_create_static(const char *tag, UBaseType_t length,
+                                      UBaseType_t item_size, uint8_t *storage,
+                                      StaticQueue_t *queue) {
+    mem_budget_add(tag, length * item_size + sizeof(StaticQueue_t), true);
+    return xQueueCreateStatic(length, item_size, storage, queue);
+}
+
+EventGroupHandle_t mem_event_group_create_static(const char *tag,
+                                                 StaticEventGroup_t *group) {
+    mem_budget_add(tag, sizeof(StaticEventGroup_t), true);
+    return xEventGroupCreateStatic(group);
+}
@@ -0,0 +1,103 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 09:12:40
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 09:12:44
+ * @FilePath    : /shellhome-nightlamp/main/board_mem.h
+ * @Description :
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef BOARD_MEM_H
+#define BOARD_MEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+
+/**
+ * @brief Kernel objects are declared with MEM_xxx_DEFINE() at file scope and
+ *        created with MEM_xxx_CREATE(). With CONFIG_LAMP_STATIC_ALLOC the
+ *        storage lives in .bss, otherwise the heap is used as before.
+ *        Every object is recorded for mem_budget_report().
+ */
+#ifdef CONFIG_LAMP_STATIC_ALLOC
+
+#define MEM_TASK_DEFINE(name, stack_size)                                     \
+    static StackType_t name##_stack[(stack_size)];                            \
+    static StaticTask_t name##_tcb
+
+#define MEM_TASK_CREATE(name, fn, tag, stack_size, arg, prio)                 \
+    mem_task_create_static((fn), (tag), (stack_size), (arg), (prio),          \
+                           name##_stack, &name##_tcb)
+
+#define MEM_QUEUE_DEFINE(name, length, item_size)                             \
+    static uint8_t name##_storage[(length) * (item_size)];                    \
+    static StaticQueue_t name##_queue
+
+#define MEM_QUEUE_CREATE(name, tag, length, item_size)                        \
+    mem_queue_create_static((tag), (length), (item_size),                     \
+                            name##_storage, &name##_queue)
+
+#define MEM_EVENT_GROUP_DEFINE(name)                                          \
+    static StaticEventGroup_t name##_group
+
+#define MEM_EVENT_GROUP_CREATE(name, tag)                                     \
+    mem_event_group_create_static((tag), &name##_group)
+
+#else
+
+#define MEM_TASK_DEFINE(name, stack_size)
+#define MEM_TASK_CREATE(name, fn, tag, stack_size, arg, prio)                 \
+    mem_task_create((fn), (tag), (stack_size), (arg), (prio))
+
+#define MEM_QUEUE_DEFINE(name, length, item_size)
+#define MEM_QUEUE_CREATE(name, tag, length, item_size)                        \
+    mem_queue_create((tag), (length), (item_size))
+
+#define MEM_EVENT_GROUP_DEFINE(name)
+#define MEM_EVENT_GROUP_CREATE(name, tag)                                     \
+    mem_event_group_create((tag))
+
+#endif /* CONFIG_LAMP_STATIC_ALLOC */
+
+// create objects on heap
+TaskHandle_t mem_task_create(TaskFunction_t fn, const char *tag,
+                             uint32_t stack_size, void *arg, UBaseType_t prio);
+QueueHandle_t mem_queue_create(const char *tag, UBaseType_t length,
+                               UBaseType_t item_size);
+EventGroupHandle_t mem_event_group_create(const char *tag);
+
+// create objects on static storage
+TaskHandle_t mem_task_create_static(TaskFunction_t fn, const char *tag,
+                                    uint32_t stack_size, void *arg,
+                                    UBaseType_t prio, StackType_t *stack,
+                                    StaticTask_t *tcb);
+QueueHandle_t mem_queue_create_static(const char *tag, UBaseType_t length,
+                                      UBaseType_t item_size, uint8_t *storage,
+                                      StaticQueue_t *queue);
+EventGroupHandle_t mem_event_group_create_static(const char *tag,
+                                                 StaticEventGroup_t *group);
+
+// record an object in the RAM budget
+void mem_budget_add(const char *tag, size_t size, bool is_static);
+
+// log the RAM budget
+void mem_budget_report(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* BOARD_MEM_H */
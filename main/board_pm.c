@@ -0,0 +1,210 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 14:30:40
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 14:30:43
+ * @FilePath    : /shellhome-nightlamp/main/board_pm.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_pm.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "board_mem.h"
+#include "board_pm.h"
+#include "board_telemetry.h"
+#include "lamp_state.h"
+
+static const char *TAG = "PM";
+
+#define PM_SLOT_NUM     (LAMP_MODE_BUTT + 1)
+#define PM_REPORT_TASK_STACK    (3 * 1024)
+
+typedef struct {
+    int64_t                  busy_us;   /*!< time the render lock was held */
+    int64_t                  wall_us;   /*!< time spent in this mode */
+    uint32_t                  max_us;   /*!< longest frame */
+    uint32_t                  frames;
+} pm_residency_t;
+
+static const char *g_slot_names[PM_SLOT_NUM] = {
+    [LAMP_MODE_MARQUEE] = "marquee",
+    [LAMP_MODE_BREATH]  = "breath",
+    [LAMP_MODE_STACK]   = "stack",
+    [LAMP_MODE_FIXED]   = "fixed",
+    [LAMP_MODE_NOISE]   = "noise",
+    [LAMP_MODE_FIRE]    = "fire",
+    [LAMP_MODE_SPARKS]  = "sparks",
+    [LAMP_MODE_COMET]   = "comet",
+    [LAMP_MODE_RAIN]    = "rain",
+    [LAMP_MODE_BUTT]    = "off",
+};
+
+static pm_residency_t g_residency[PM_SLOT_NUM];
+static int64_t g_frame_begin_us = 0;
+static int64_t g_last_end_us = 0;
+/**< slot of the last frame, what is shown until the next one begins */
+static uint32_t g_last_slot = LAMP_MODE_BUTT;
+/**< frames update the residency, the report timer reads and resets it */
+static portMUX_TYPE g_residency_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t g_report_timer = NULL;
+static TaskHandle_t g_report_task = NULL;
+
+MEM_TASK_DEFINE(pm_report, PM_REPORT_TASK_STACK);
+
+#ifdef CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t g_render_lock = NULL;
+static esp_pm_lock_handle_t g_awake_lock = NULL;
+static bool g_awake = false;
+#endif
+
+/**< report from a timer, an idle renderer does not end frames any more */
+static void report_timer_cb(void *args) {
+    // logging would stall every other esp_timer callback, hand it over
+    xTaskNotifyGive(g_report_task);
+}
+
+static void report_task(void *arg) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        board_pm_report();
+    }
+}
+
+esp_err_t board_pm_init(void) {
+    // the lowest priority above idle, a busy lamp delays its report
+    g_report_task = MEM_TASK_CREATE(pm_report, report_task, "pm_report",
+                                    PM_REPORT_TASK_STACK, NULL, 1);
+    if (NULL == g_report_task) {
+        return ESP_FAIL;
+    }
+    esp_timer_create_args_t report_cnf = {
+        .arg = NULL,
+        .callback = report_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "pm_report",
+        .skip_unhandled_events = true,
+    };
+    esp_err_t ret = esp_timer_create(&report_cnf, &g_report_timer);
+    if (ESP_OK == ret) {
+        ret = esp_timer_start_periodic(g_report_timer, CONFIG_LAMP_PM_REPORT_S * 1000000ULL);
+    }
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "report timer failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+#ifdef CONFIG_PM_ENABLE
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_LAMP_PM_MIN_FREQ_MHZ,
+#ifdef CONFIG_FREERTOS_USE_TICKLESS_IDLE
+        .light_sleep_enable = true,
+#endif
+    };
+    esp_err_t err = esp_pm_configure(&pm_config);
+    if (ESP_OK != err) {
+        ESP_LOGE(TAG, "configure pm failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "render", &g_render_lock);
+    if (ESP_OK != err) {
+        return err;
+    }
+    err = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "pwm", &g_awake_lock);
+    if (ESP_OK != err) {
+        return err;
+    }
+    ESP_LOGI(TAG, "dfs %d-%d MHz, light sleep %s",
+             pm_config.min_freq_mhz, pm_config.max_freq_mhz,
+             pm_config.light_sleep_enable ? "on" : "off");
+#else
+    ESP_LOGI(TAG, "power management disabled, residency only");
+#endif
+    return ESP_OK;
+}
+
+void board_pm_frame_begin(void) {
+#ifdef CONFIG_PM_ENABLE
+    esp_pm_lock_acquire(g_render_lock);
+#endif
+    g_frame_begin_us = esp_timer_get_time();
+}
+
+void board_pm_frame_end(uint32_t mode) {
+    int64_t now = esp_timer_get_time();
+#ifdef CONFIG_PM_ENABLE
+    esp_pm_lock_release(g_render_lock);
+#endif
+
+    uint32_t index = mode < PM_SLOT_NUM ? mode : LAMP_MODE_BUTT;
+    pm_residency_t *slot = &g_residency[index];
+    uint32_t busy_us = now - g_frame_begin_us;
+    taskENTER_CRITICAL(&g_residency_lock);
+    // the gap before this frame still showed the previous one, minus what a
+    // report in between already took
+    if (g_last_end_us && g_frame_begin_us > g_last_end_us) {
+        g_residency[g_last_slot].wall_us += g_frame_begin_us - g_last_end_us;
+    }
+    slot->busy_us += busy_us;
+    slot->wall_us += busy_us;
+    slot->max_us = busy_us > slot->max_us ? busy_us : slot->max_us;
+    slot->frames++;
+    g_last_end_us = now;
+    g_last_slot = index;
+    taskEXIT_CRITICAL(&g_residency_lock);
+    board_telemetry_frame(mode, busy_us);
+}
+
+void board_pm_keep_awake(bool awake) {
+#ifdef CONFIG_PM_ENABLE
+    if (awake != g_awake) {
+        g_awake = awake;
+        if (awake) {
+            esp_pm_lock_acquire(g_awake_lock);
+        } else {
+            esp_pm_lock_release(g_awake_lock);
+        }
+    }
+#endif
+}
+
+void board_pm_report(void) {
+    pm_residency_t residency[PM_SLOT_NUM];
+    int64_t now = esp_timer_get_time();
+
+    taskENTER_CRITICAL(&g_residency_lock);
+    // a static frame blocks the renderer, its idle time so far counts here
+    if (g_last_end_us) {
+        g_residency[g_last_slot].wall_us += now - g_last_end_us;
+        g_last_end_us = now;
+    }
+    memcpy(residency, g_residency, sizeof(g_residency));
+    memset(g_residency, 0, sizeof(g_residency));
+    taskEXIT_CRITICAL(&g_residency_lock);
+
+    ESP_LOGI(TAG, "render lock residency:");
+    for (uint32_t i = 0; i < PM_SLOT_NUM; i++) {
+        pm_residency_t *slot = &residency[i];
+        // an idle mode shows up with its wall time and no frames
+        if (0 == slot->frames && 0 == slot->wall_us) {
+            continue;
+        }
+        uint32_t permille = slot->wall_us ? (uint32_t)(slot->busy_us * 1000 / slot->wall_us) : 0;
+        ESP_LOGI(TAG, "  %-8s %6"PRIu32" frames, %6"PRId64" ms, cpu max %3"PRIu32".%"PRIu32"%%, "
+                 "frame avg %"PRIu32" max %"PRIu32" us",
+                 g_slot_names[i], slot->frames, slot->wall_us / 1000,
+                 permille / 10, permille % 10,
+                 slot->frames ? (uint32_t)(slot->busy_us / slot->frames) : 0, slot->max_us);
+    }
+}
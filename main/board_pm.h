@@ -0,0 +1,47 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 14:30:26
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 14:30:29
+ * @FilePath    : /shellhome-nightlamp/main/board_pm.h
+ * @Description :
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef BOARD_PM_H
+#define BOARD_PM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// configure dynamic frequency scaling and light sleep
+esp_err_t board_pm_init(void);
+
+// hold the CPU at full speed while a frame is computed and sent
+void board_pm_frame_begin(void);
+
+// release the CPU, the frame is accounted to mode (LAMP_MODE_BUTT when off)
+void board_pm_frame_end(uint32_t mode);
+
+// forbid light sleep while a PWM output has to keep running
+void board_pm_keep_awake(bool awake);
+
+// log per-mode residency of the render lock, runs from a timer every
+// CONFIG_LAMP_PM_REPORT_S
+void board_pm_report(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* BOARD_PM_H */
@@ -10,6 +10,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 #include <sys/cdefs.h>
 
 #include "esp_err.h"
@@ -20,24 +21,120 @@
 #include "esp_timer.h"
 #include "esp_idf_version.h"
 
+#include "board_mem.h"
 #include "board_sensor.h"
-#include "iot_button.h"
+#include "board_trace.h"
+#include "board_telemetry.h"
+#include "lamp_gesture.h"
+#include "lamp_record.h"
+#include "lamp_latency.h"
+#include "driver/gpio.h"
+#ifdef CONFIG_PM_ENABLE
+#include "esp_sleep.h"
+#endif
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include "esp_adc/adc_oneshot.h"
+#include "esp_adc/adc_cali.h"
+#include "esp_adc/adc_cali_scheme.h"
+#else
+#include "driver/adc.h"
+#include "esp_adc_cal.h"
+#endif
 
 extern EventGroupHandle_t g_event_group;
+extern lamp_latency_t g_latency;
 
 static const char *TAG = "SENSOR";
 
 
-static uint8_t btn1_pressed = 0;
-static uint8_t btn2_pressed = 1;
+/*
+ * scheduler: GPIO interrupts catch the vibration hits and wake the button
+ * tick, which runs only while a button is pressed or settling; a slow timer
+ * samples the battery and counts the report period
+ */
+#define SENSOR_TICK_US      (CONFIG_SENSOR_TICK_MS * 1000)
+#define SENSOR_SLOW_US      (CONFIG_SENSOR_SLOW_MS * 1000)
+
+typedef enum {
+    SENSOR_EDGE_VIBRATION,      /*!< ms: time of a debounced falling edge */
+    SENSOR_EDGE_BUTTON,         /*!< a button moved, start the tick */
+    SENSOR_EDGE_IDLE,           /*!< ms: wake generation the tick found nothing to do at */
+} sensor_edge_type_t;
+
+/**< what the interrupts and the tick hand to the vibration task */
+typedef struct {
+    uint32_t                    type;   /*!< sensor_edge_type_t */
+    uint32_t                      ms;
+} sensor_edge_t;
+
+typedef struct {
+    uint32_t                     seq;
+    sensor_values_t           values;
+} sensor_state_t;
+
+static sensor_state_t g_sensor_state;
+static sensor_values_t g_sensor_values;     /**< owned by the scheduler */
+static esp_timer_handle_t g_sensor_timer = NULL;
+static esp_timer_handle_t g_slow_timer = NULL;
+/**< bumped by every button interrupt, a tick idle since an older one goes on */
+static uint32_t g_wake_gen = 0;
+static bool g_tick_on = false;          /**< started by the vibration task only */
+static bool g_tick_restart = false;     /**< next tick starts the lateness over */
+static uint32_t g_vibration_hits = 0;   /**< counted by the interrupt */
+
+/**< scheduler numbers of one report period, printed by the report task */
+typedef struct {
+    uint32_t                 wakeups;   /*!< per second */
+    uint32_t                    hits;
+    int32_t              late_max_us;
+} sensor_report_t;
+
+#define SENSOR_REPORT_TASK_STACK    (1024 * 2)
+/**< notify bits of the report task */
+#define SENSOR_REPORT_PERIOD        BIT0
+#define SENSOR_REPORT_BATTERY       BIT1
+MEM_TASK_DEFINE(sensor_report, SENSOR_REPORT_TASK_STACK);
+static TaskHandle_t g_report_task = NULL;
+/**< written by the scheduler once a period, read right after the notify */
+static sensor_report_t g_report;
+/**< battery voltage worth a log line, handed over like the report */
+static int32_t g_report_mv = 0;
+
+/* buttons, active low */
+#define SENSOR_BTN_NUM      2
+
+typedef enum {
+    SENSOR_BUTTON_PRESS_DOWN,
+    SENSOR_BUTTON_LONG_PRESS,
+} sensor_button_event_t;
+
+typedef struct {
+    int32_t                     gpio;
+    uint8_t                  pressed;   /*!< debounced state */
+    uint8_t                   stable;   /*!< samples the raw state differed */
+    uint8_t                long_sent;
+    uint32_t                press_ms;
+    int64_t                  edge_us;   /*!< first sample of the new raw state */
+} sensor_button_t;
+
+static sensor_button_t g_buttons[SENSOR_BTN_NUM] = {
+    [SENSOR_BTN_1] = {.gpio = CONFIG_GPIO_BTN_1},
+    [SENSOR_BTN_2] = {.gpio = CONFIG_GPIO_BTN_2},
+};
 
 /*  vibration */
-typedef void (*vibration_isr_t)(void *);
+typedef void (*vibration_gesture_cb_t)(lamp_gesture_t gesture, void *arg);
 
 static QueueHandle_t g_gpio_evt_queue  = NULL;
-static vibration_isr_t g_vibration_fn = NULL;
+static vibration_gesture_cb_t g_vibration_fn = NULL;
 static void *g_vibration_fn_arg       = NULL;
-static int32_t g_is_enable_vibration = 1;
+static int32_t g_vibration_gpio       = GPIO_NUM_NC;
+
+/**< edges buffered between the interrupts and the recognizer */
+#define VIBRATION_QUEUE_LEN     16
+#define VIBRATION_TASK_STACK    (1024 * 2)
+MEM_TASK_DEFINE(vibration, VIBRATION_TASK_STACK);
+MEM_QUEUE_DEFINE(vibration, VIBRATION_QUEUE_LEN, sizeof(sensor_edge_t));
 
 /* battery */
 #ifdef CONFIG_BATTERY_IN_USE
@@ -49,7 +146,10 @@ typedef enum {
 
 static int32_t g_bat_chrg_num = 0;
 static int32_t g_bat_stby_num = 0;
-static int32_t g_vol_bat = 0;
+static int32_t g_bat_logged_mv = 0;
+
+/**< log the voltage when it moved by this much */
+#define BATTERY_LOG_DELTA_MV    50
 
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
 
@@ -114,7 +214,12 @@ static bool example_adc_calibration_init(adc_unit_t unit, adc_atten_t atten, adc
 #else
 #define DEFAULT_VREF    1100        /**< Use adc2_vref_to_gpio() to obtain a better estimate */
 #define NO_OF_SAMPLES   16          /**< Multisampling */
+#ifdef CONFIG_LAMP_STATIC_ALLOC
+static esp_adc_cal_characteristics_t g_adc_chars_storage;
+static esp_adc_cal_characteristics_t *g_adc_chars = &g_adc_chars_storage;
+#else
 static esp_adc_cal_characteristics_t *g_adc_chars;
+#endif
 static int32_t g_adc_ch_bat = 0;
 
 static void adc_check_efuse()
@@ -181,24 +286,38 @@ static void adc_get_voltage(int32_t *out_voltage)
 #endif
 }
 
-static void adc_proid_sample(TimerHandle_t xTimer)
+static void battery_sample(sensor_values_t *values)
 {
-    adc_get_voltage(&g_vol_bat);
+    int32_t voltage = 0;
+    adc_get_voltage(&voltage);
     /**< The resistance on the hardware has decreased twice */
-    g_vol_bat *= 2;
+    values->battery_mv = voltage * 2;
+
+    /**< Low level active */
+    uint8_t chrg = GPIO_NUM_NC != g_bat_chrg_num ? !gpio_get_level(g_bat_chrg_num) : 0;
+    uint8_t stby = GPIO_NUM_NC != g_bat_stby_num ? !gpio_get_level(g_bat_stby_num) : 0;
+    values->chrg_state = (chrg << 1) | stby;
+
+    TRACE(TRACE_BATTERY, values->battery_mv, values->chrg_state);
+    if (abs(values->battery_mv - g_bat_logged_mv) >= BATTERY_LOG_DELTA_MV) {
+        // logged by the report task, the tick only keeps the value
+        g_bat_logged_mv = values->battery_mv;
+        __atomic_store_n(&g_report_mv, values->battery_mv, __ATOMIC_RELAXED);
+        xTaskNotify(g_report_task, SENSOR_REPORT_BATTERY, eSetBits);
+    }
 }
 
 esp_err_t sensor_battery_get_info(int32_t *voltage, uint8_t *chrg_state)
 {
+    sensor_values_t values;
+    sensor_snapshot(&values);
+
     if (NULL != voltage) {
-        *voltage = g_vol_bat;
+        *voltage = values.battery_mv;
     }
 
     if (NULL != chrg_state) {
-        /**< Low level active */
-        uint8_t chrg = !gpio_get_level(g_bat_chrg_num);
-        uint8_t stby = !gpio_get_level(g_bat_stby_num);
-        *chrg_state = (chrg << 1) | stby;
+        *chrg_state = values.chrg_state;
     }
 
     return ESP_OK;
@@ -232,25 +351,6 @@ esp_err_t sensor_battery_get_info_simple(int32_t *level, chrg_state_t *state)
 }
 
 
-static void sensor_battery_task(void *arg)
-{
-    static TimerHandle_t tmr;
-    tmr = xTimerCreate("adc measure",
-                       10 / portTICK_PERIOD_MS,
-                       pdTRUE,
-                       NULL,
-                       adc_proid_sample);
-
-    if (tmr) {
-        xTimerStart(tmr, 0);
-    }
-
-    while (1) {
-        ESP_LOGI(TAG, "battery voltage: %"PRId32"mv", g_vol_bat);
-        vTaskDelay(pdMS_TO_TICKS(5000));
-    }
-}
-
 esp_err_t sensor_battery_init(int32_t adc_channel, int32_t chrg_num, int32_t stby_num)
 {
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
@@ -268,6 +368,8 @@ esp_err_t sensor_battery_init(int32_t adc_channel, int32_t chrg_num, int32_t stb
 
     //-------------ADC1 Calibration Init---------------//
     do_calibration = example_adc_calibration_init(ADC_UNIT_1, (ADC_ATTEN_DB_6 + 1), &battery_adc_cali_handle);
+    g_bat_chrg_num = chrg_num;
+    g_bat_stby_num = stby_num;
 #else
     g_adc_ch_bat = adc_channel;
     g_bat_chrg_num = chrg_num;
@@ -280,7 +382,12 @@ esp_err_t sensor_battery_init(int32_t adc_channel, int32_t chrg_num, int32_t stb
     adc1_config_channel_atten(g_adc_ch_bat, ADC_ATTEN_DB_12);
 
     /**< Characterize ADC */
+#ifdef CONFIG_LAMP_STATIC_ALLOC
+    mem_budget_add("adc_chars", sizeof(esp_adc_cal_characteristics_t), true);
+#else
     g_adc_chars = calloc(1, sizeof(esp_adc_cal_characteristics_t));
+    mem_budget_add("adc_chars", sizeof(esp_adc_cal_characteristics_t), false);
+#endif
     esp_adc_cal_value_t val_type = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_12, ADC_WIDTH_BIT_12, DEFAULT_VREF, g_adc_chars);
     print_char_val_type(val_type);
 
@@ -303,59 +410,121 @@ esp_err_t sensor_battery_init(int32_t adc_channel, int32_t chrg_num, int32_t stb
         gpio_config(&io_conf);
     }
 
-    xTaskCreate(sensor_battery_task, "battery", 1024 * 2, NULL, 3, NULL);
+    // sampled by the scheduler from now on
     return ESP_OK;
 }
 
 #endif /* CONFIG_BATTERY_IN_USE */
 
-static void sensor_vibration_task(void *arg)
+/**< start the button tick, vibration task only */
+static void sensor_tick_start(void)
 {
-    int32_t gpio_num = (int32_t)arg;
-
-    while (1) {
-        int32_t io_num;
-        uint8_t level;
-
-        if (xQueueReceive(g_gpio_evt_queue, &io_num, portMAX_DELAY)) {
-            level = gpio_get_level(io_num);
-            ESP_LOGI(TAG, "GPIO[%"PRId32"] intr, val: %d\n", io_num, level);
-
-            if (io_num == gpio_num) {
-                /**
-                 * remove isr handler for gpio number.
-                 * Discard interrupts generated during the delay period
-                 */
+    if (__atomic_load_n(&g_tick_on, __ATOMIC_SEQ_CST)) {
+        return;
+    }
+    __atomic_store_n(&g_tick_restart, true, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_tick_on, true, __ATOMIC_SEQ_CST);
+    esp_timer_start_periodic(g_sensor_timer, SENSOR_TICK_US);
+}
 
-                if (NULL != g_vibration_fn) {
-                    g_vibration_fn(g_vibration_fn_arg);
-                }
+/**< stop the button tick unless a button moved since gen, vibration task only */
+static void sensor_tick_idle(uint32_t gen)
+{
+    if (!__atomic_load_n(&g_tick_on, __ATOMIC_SEQ_CST)) {
+        return;
+    }
+    // cleared before the check, an interrupt after it queues a new start
+    __atomic_store_n(&g_tick_on, false, __ATOMIC_SEQ_CST);
+    if (gen != __atomic_load_n(&g_wake_gen, __ATOMIC_SEQ_CST)) {
+        __atomic_store_n(&g_tick_on, true, __ATOMIC_SEQ_CST);
+        return;
+    }
+    esp_timer_stop(g_sensor_timer);
+}
 
-                vTaskDelay(pdMS_TO_TICKS(250));
-                g_is_enable_vibration = 1;
-            }
+static void IRAM_ATTR sensor_gpio_isr(void *arg)
+{
+    sensor_edge_t edge = {.type = (uint32_t)arg};
+    int64_t now_us = esp_timer_get_time();
+    BaseType_t woken = pdFALSE;
+
+    if (SENSOR_EDGE_VIBRATION == edge.type) {
+        static int64_t last_us = 0;
+        // the bounces of one hit never reach the queue
+        if (now_us - last_us < CONFIG_VIBRATION_DEBOUNCE_MS * 1000LL) {
+            return;
+        }
+        last_us = now_us;
+        __atomic_add_fetch(&g_vibration_hits, 1, __ATOMIC_RELAXED);
+        edge.ms = (uint32_t)(now_us / 1000);
+    } else {
+        __atomic_add_fetch(&g_wake_gen, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&g_tick_on, __ATOMIC_SEQ_CST)) {
+            // the running tick samples it
+            return;
         }
     }
+    xQueueSendFromISR(g_gpio_evt_queue, &edge, &woken);
+    portYIELD_FROM_ISR(woken);
 }
 
-static void periodic_timer_callback(void *arg)
+/**
+ * @brief Gesture recognizer, and the only task starting and stopping the
+ *        button tick so a start and a stop never cross
+ *
+ */
+static void sensor_vibration_task(void *arg)
 {
-    static int8_t last_level = 1;
-    int8_t level;
-    int32_t gpio_num = (int32_t)arg;
+    lamp_gesture_rec_t rec;
+    lamp_gesture_config_t cfg = {
+        .debounce_ms = CONFIG_VIBRATION_DEBOUNCE_MS,
+        .double_ms   = CONFIG_VIBRATION_DOUBLE_MS,
+        .shake_ms    = CONFIG_VIBRATION_SHAKE_MS,
+        .shake_hits  = CONFIG_VIBRATION_SHAKE_HITS,
+    };
+    lamp_gesture_init(&rec, &cfg);
 
-    level = gpio_get_level(gpio_num);
+    while (1) {
+        sensor_edge_t edge;
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        uint32_t timeout = lamp_gesture_timeout(&rec, now_ms);
+        TickType_t ticks = UINT32_MAX == timeout ? portMAX_DELAY : pdMS_TO_TICKS(timeout) + 1;
+        lamp_gesture_t gesture = LAMP_GESTURE_NONE;
+
+        if (xQueueReceive(g_gpio_evt_queue, &edge, ticks)) {
+            if (SENSOR_EDGE_BUTTON == edge.type) {
+                sensor_tick_start();
+                continue;
+            } else if (SENSOR_EDGE_IDLE == edge.type) {
+                sensor_tick_idle(edge.ms);
+                continue;
+            }
+            // every hit feeds the particle effects as well, the interrupt debounced it
+#ifdef CONFIG_LAMP_LATENCY
+            // back from the ms of the edge to the 64 bit clock, wrap safe
+            int64_t now_us = esp_timer_get_time();
+            uint32_t age_ms = (uint32_t)(now_us / 1000) - edge.ms;
+            lamp_latency_input(&g_latency, LAMP_CTRL_KICK, LAMP_LATENCY_KICK,
+                               now_us - age_ms * 1000LL);
+#endif
+            xEventGroupSetBits(g_event_group, EVENT_KICK_BITS);
+            TELEMETRY(TELEMETRY_VIBRATION, 0, 0,
+                      __atomic_load_n(&g_vibration_hits, __ATOMIC_RELAXED), 0);
+            gesture = lamp_gesture_feed(&rec, edge.ms);
+        } else {
+            gesture = lamp_gesture_poll(&rec, (uint32_t)(esp_timer_get_time() / 1000));
+        }
 
-    /**< Find a falling edge */
-    if ((1 == g_is_enable_vibration) && (0 == level) && (1 == last_level)) {
-        g_is_enable_vibration = 0;
-        xQueueOverwrite(g_gpio_evt_queue, &gpio_num);
+        if (LAMP_GESTURE_NONE != gesture) {
+            TRACE(TRACE_GESTURE, gesture, __atomic_load_n(&g_vibration_hits, __ATOMIC_RELAXED));
+            if (NULL != g_vibration_fn) {
+                g_vibration_fn(gesture, g_vibration_fn_arg);
+            }
+        }
     }
-
-    last_level = level;
 }
 
-esp_err_t sensor_vibration_triggered_register(vibration_isr_t fn, void *arg)
+esp_err_t sensor_vibration_triggered_register(vibration_gesture_cb_t fn, void *arg)
 {
     g_vibration_fn = fn;
     g_vibration_fn_arg = arg;
@@ -366,8 +535,8 @@ esp_err_t sensor_vibration_init(int32_t gpio_num)
 {
     gpio_config_t io_conf = {0};
 
-    /**< interrupt of rising edge */
-    io_conf.intr_type = GPIO_INTR_DISABLE;
+    /**< interrupt of falling edge, a hit */
+    io_conf.intr_type = GPIO_INTR_NEGEDGE;
     /**< bit mask of the pins */
     io_conf.pin_bit_mask = (((uint64_t) 1) << gpio_num);
     /**< set as input mode */
@@ -377,77 +546,337 @@ esp_err_t sensor_vibration_init(int32_t gpio_num)
     gpio_config(&io_conf);
 
     /**< create a queue to handle gpio event from isr */
-    g_gpio_evt_queue = xQueueCreate(1, sizeof(uint32_t));
+    g_gpio_evt_queue = MEM_QUEUE_CREATE(vibration, "vibration_queue",
+                                        VIBRATION_QUEUE_LEN, sizeof(sensor_edge_t));
 
     if (g_gpio_evt_queue == NULL) {
         return ESP_FAIL;
     }
 
-    /**< install gpio isr service */
-    esp_timer_create_args_t periodic_timer_args = {
-        .callback = &periodic_timer_callback,
-        .arg = (void *)gpio_num,
-        /* name is optional, but may help identify the timer when debugging */
-        .name = "periodic"
-    };
-
-    esp_timer_handle_t periodic_timer;
-    ESP_ERROR_CHECK(esp_timer_create(&periodic_timer_args, &periodic_timer));
-    /* Start the timers */
-    ESP_ERROR_CHECK(esp_timer_start_periodic(periodic_timer, 5000));
-
-    xTaskCreate(sensor_vibration_task, "vibration", 1024 * 2, (void *)gpio_num, 3, NULL);
+    g_vibration_gpio = gpio_num;
+    esp_err_t err = gpio_isr_handler_add(gpio_num, sensor_gpio_isr,
+                                         (void *)SENSOR_EDGE_VIBRATION);
+    if (ESP_OK != err) {
+        return err;
+    }
+#ifdef CONFIG_PM_ENABLE
+    // edges don't wake the chip from light sleep, the level does
+    gpio_wakeup_enable(gpio_num, GPIO_INTR_LOW_LEVEL);
+#endif
 
-    return ESP_OK;
+    TaskHandle_t task = MEM_TASK_CREATE(vibration, sensor_vibration_task, "vibration",
+                                        VIBRATION_TASK_STACK, (void *)gpio_num, 3);
+    return NULL == task ? ESP_FAIL : ESP_OK;
 }
 
 
-static void vibration_handle(void *arg)
+static void vibration_handle(lamp_gesture_t gesture, void *arg)
 {
-    xEventGroupSetBits(g_event_group, EVENT_MODE_BITS);
+    LAMP_RECORD((uint32_t)(esp_timer_get_time() / 1000), LAMP_RECORD_GESTURE,
+                gesture, 0, 0);
+#ifdef CONFIG_LAMP_LATENCY
+    static const uint8_t ctrl[LAMP_GESTURE_BUTT] = {
+        [LAMP_GESTURE_NONE]       = LAMP_CTRL_BUTT,
+        [LAMP_GESTURE_TAP]        = LAMP_CTRL_MODE,
+        [LAMP_GESTURE_DOUBLE_TAP] = LAMP_CTRL_COLOR,
+        [LAMP_GESTURE_KNOCK]      = LAMP_CTRL_TIMER,
+        [LAMP_GESTURE_SHAKE]      = LAMP_CTRL_OFF,
+    };
+    // the probe starts at recognition, the gesture windows are by design
+    if (gesture < LAMP_GESTURE_BUTT) {
+        lamp_latency_input(&g_latency, ctrl[gesture], LAMP_LATENCY_GESTURE,
+                           esp_timer_get_time());
+    }
+#endif
+    switch (gesture) {
+        case LAMP_GESTURE_TAP:
+            xEventGroupSetBits(g_event_group, EVENT_MODE_BITS);
+            break;
+
+        case LAMP_GESTURE_DOUBLE_TAP:
+            xEventGroupSetBits(g_event_group, EVENT_COLOR_BITS);
+            break;
+
+        case LAMP_GESTURE_KNOCK:
+            xEventGroupSetBits(g_event_group, EVENT_TIMER_BITS);
+            break;
+
+        case LAMP_GESTURE_SHAKE:
+            xEventGroupSetBits(g_event_group, EVENT_OFF_BITS);
+            break;
+
+        default:
+            break;
+    }
 }
 
-static void button_press_down_cb(void *arg, void *data)
+static void button_event(uint8_t btn, sensor_button_event_t event)
 {
-    uint8_t btn = *(uint8_t *)data;
-    if (btn1_pressed == btn) {
+    TRACE(TRACE_BUTTON, btn, event);
+    if (SENSOR_BUTTON_LONG_PRESS == event) {
+#if defined(CONFIG_LAMP_RECORD) || defined(CONFIG_LAMP_LATENCY)
+        if (SENSOR_BTN_2 == btn) {
+            // printing blocks, let leds_task dump the records
+            xEventGroupSetBits(g_event_group, EVENT_DUMP_BITS);
+        }
+#endif
+        return;
+    }
+
+    LAMP_RECORD((uint32_t)(esp_timer_get_time() / 1000), LAMP_RECORD_BUTTON,
+                btn, 0, 0);
+    // the probe starts at the edge, before the debounce samples
+    if (SENSOR_BTN_1 == btn) {
+        LAMP_LATENCY_INPUT(&g_latency, LAMP_CTRL_COLOR, LAMP_LATENCY_BUTTON_1,
+                           g_buttons[btn].edge_us);
         xEventGroupSetBits(g_event_group, EVENT_COLOR_BITS);
     } else {
+        LAMP_LATENCY_INPUT(&g_latency, LAMP_CTRL_TIMER, LAMP_LATENCY_BUTTON_2,
+                           g_buttons[btn].edge_us);
         xEventGroupSetBits(g_event_group, EVENT_TIMER_BITS);
     }
 }
 
+/**
+ * @brief Debounce one button, a new state must hold for
+ *        CONFIG_SENSOR_BUTTON_DEBOUNCE samples in a row
+ *
+ */
+/**< true while the button needs the tick, settling or waiting for the long press */
+static bool button_sample(uint8_t btn, int64_t now_us, sensor_values_t *values)
+{
+    uint32_t now_ms = (uint32_t)(now_us / 1000);
+    sensor_button_t *button = &g_buttons[btn];
+    uint8_t pressed = 0 == gpio_get_level(button->gpio);
+
+    if (pressed != button->pressed) {
+        if (1 == ++button->stable) {
+            button->edge_us = now_us;
+        }
+        if (button->stable < CONFIG_SENSOR_BUTTON_DEBOUNCE) {
+            return true;
+        }
+        button->pressed = pressed;
+        button->stable = 0;
+        if (pressed) {
+            button->press_ms = now_ms;
+            button->long_sent = 0;
+            values->buttons |= 1 << btn;
+            button_event(btn, SENSOR_BUTTON_PRESS_DOWN);
+        } else {
+            values->buttons &= ~(1 << btn);
+        }
+    } else {
+        button->stable = 0;
+        if (pressed && !button->long_sent &&
+                now_ms - button->press_ms >= CONFIG_SENSOR_LONG_PRESS_MS) {
+            button->long_sent = 1;
+            button_event(btn, SENSOR_BUTTON_LONG_PRESS);
+        }
+    }
+    // the release wakes the tick again
+    return button->pressed && !button->long_sent;
+}
+
+static esp_err_t sensor_button_init(void)
+{
+    gpio_config_t io_conf = {0};
+
+    /**< any edge wakes the tick, which debounces */
+    io_conf.intr_type = GPIO_INTR_ANYEDGE;
+    io_conf.mode = GPIO_MODE_INPUT;
+    io_conf.pull_up_en = 1;
+    for (uint8_t i = 0; i < SENSOR_BTN_NUM; i++) {
+        io_conf.pin_bit_mask |= ((uint64_t) 1) << g_buttons[i].gpio;
+    }
+    return gpio_config(&io_conf);
+}
+
+static void sensor_publish(const sensor_values_t *values)
+{
+    uint32_t seq = __atomic_load_n(&g_sensor_state.seq, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&g_sensor_state.seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&g_sensor_state.values, values, sizeof(sensor_values_t));
+    __atomic_store_n(&g_sensor_state.seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void sensor_snapshot(sensor_values_t *values)
+{
+    uint32_t seq;
+
+    do {
+        seq = __atomic_load_n(&g_sensor_state.seq, __ATOMIC_ACQUIRE);
+        memcpy(values, &g_sensor_state.values, sizeof(sensor_values_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || seq != __atomic_load_n(&g_sensor_state.seq, __ATOMIC_RELAXED));
+}
+
+/**< dispatch latency, anything else on the esp_timer task delays us */
+static int32_t g_late_max_us = 0;
+
+static void sched_late(int64_t *due_us, int64_t now_us, int64_t period_us)
+{
+    if (0 != *due_us) {
+        int64_t late_us = now_us - *due_us;
+        g_late_max_us = late_us > g_late_max_us ? late_us : g_late_max_us;
+    }
+    *due_us = (0 == *due_us ? now_us : *due_us) + period_us;
+}
+
+/**
+ * @brief Button tick, runs from a button interrupt until every button is
+ *        idle again, then asks the vibration task to stop it
+ *
+ */
+static void sensor_tick(void *arg)
+{
+    static int64_t due_us = 0;
+    static uint32_t idle_gen = 0;
+    sensor_values_t *values = &g_sensor_values;
+    // read first, an interrupt from here on keeps the tick going
+    uint32_t gen = __atomic_load_n(&g_wake_gen, __ATOMIC_SEQ_CST);
+    int64_t now_us = esp_timer_get_time();
+    bool busy = false;
+
+    if (__atomic_exchange_n(&g_tick_restart, false, __ATOMIC_RELAXED)) {
+        due_us = 0;
+    }
+    sched_late(&due_us, now_us, SENSOR_TICK_US);
+
+    values->ticks++;
+    for (uint8_t i = 0; i < SENSOR_BTN_NUM; i++) {
+        busy |= button_sample(i, now_us, values);
+    }
+    values->hits = __atomic_load_n(&g_vibration_hits, __ATOMIC_RELAXED);
+    sensor_publish(values);
+
+    // without the vibration task nobody stops the tick, it keeps running
+    if (!busy && gen != idle_gen && NULL != g_gpio_evt_queue) {
+        sensor_edge_t edge = {.type = SENSOR_EDGE_IDLE, .ms = gen};
+        if (xQueueSend(g_gpio_evt_queue, &edge, 0)) {
+            idle_gen = gen;
+        }
+    }
+}
+
+/**
+ * @brief Slow tick, samples the battery and counts the report period
+ *
+ */
+static void sensor_slow(void *arg)
+{
+    static int64_t due_us = 0;
+    static uint32_t report_ticks = 0;
+    static uint32_t ticks = 0;
+    sensor_values_t *values = &g_sensor_values;
+
+    sched_late(&due_us, esp_timer_get_time(), SENSOR_SLOW_US);
+
+    values->ticks++;
+    values->hits = __atomic_load_n(&g_vibration_hits, __ATOMIC_RELAXED);
+    if (GPIO_NUM_NC != g_vibration_gpio) {
+        values->vibration = gpio_get_level(g_vibration_gpio);
+    }
+#ifdef CONFIG_BATTERY_IN_USE
+    battery_sample(values);
+#endif
+    sensor_publish(values);
+#ifdef CONFIG_LAMP_TIER
+    // after the publish, the snapshot of leds_task holds the sample
+    xEventGroupSetBits(g_event_group, EVENT_BATTERY_BITS);
+#endif
+
+    if (++report_ticks * CONFIG_SENSOR_SLOW_MS >= CONFIG_LAMP_PM_REPORT_S * 1000) {
+        // logging here would delay the next tick, hand it over
+        g_report = (sensor_report_t){
+            .wakeups = (values->ticks - ticks) / CONFIG_LAMP_PM_REPORT_S,
+            .hits = values->hits,
+            .late_max_us = g_late_max_us,
+        };
+        xTaskNotify(g_report_task, SENSOR_REPORT_PERIOD, eSetBits);
+        ticks = values->ticks;
+        report_ticks = 0;
+        g_late_max_us = 0;
+    }
+}
+
+static void sensor_report_task(void *arg)
+{
+    uint32_t bits;
+
+    while (1) {
+        xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+        if (bits & SENSOR_REPORT_BATTERY) {
+            ESP_LOGI(TAG, "battery voltage: %"PRId32"mv",
+                     __atomic_load_n(&g_report_mv, __ATOMIC_RELAXED));
+        }
+        if (bits & SENSOR_REPORT_PERIOD) {
+            ESP_LOGI(TAG, "%"PRIu32" wake-ups/s, %"PRIu32" vibration hits, dispatch late %"PRId32" us at worst",
+                     g_report.wakeups, g_report.hits, g_report.late_max_us);
+        }
+    }
+}
+
+static esp_err_t sensor_sched_start(void)
+{
+    // the lowest priority above idle, the report may wait
+    g_report_task = MEM_TASK_CREATE(sensor_report, sensor_report_task, "sensor_report",
+                                    SENSOR_REPORT_TASK_STACK, NULL, 1);
+    if (NULL == g_report_task) {
+        return ESP_FAIL;
+    }
+    esp_timer_create_args_t timer_args = {
+        .callback = &sensor_tick,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "sensors"
+    };
+
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &g_sensor_timer), TAG, "create scheduler failed");
+    timer_args.callback = &sensor_slow;
+    timer_args.name = "sensors_slow";
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &g_slow_timer), TAG, "create slow timer failed");
+    ESP_LOGI(TAG, "scheduler: buttons every %d ms while active, battery every %d ms",
+             CONFIG_SENSOR_TICK_MS, CONFIG_SENSOR_SLOW_MS);
+    ESP_RETURN_ON_ERROR(esp_timer_start_periodic(g_slow_timer, SENSOR_SLOW_US), TAG, "start slow timer failed");
+
+    if (NULL == g_gpio_evt_queue) {
+        // nobody to start and stop the tick, sample the buttons all the time
+        return esp_timer_start_periodic(g_sensor_timer, SENSOR_TICK_US);
+    }
+    for (uint8_t i = 0; i < SENSOR_BTN_NUM; i++) {
+        ESP_RETURN_ON_ERROR(gpio_isr_handler_add(g_buttons[i].gpio, sensor_gpio_isr,
+                                                 (void *)SENSOR_EDGE_BUTTON),
+                            TAG, "add button interrupt failed");
+#ifdef CONFIG_PM_ENABLE
+        gpio_wakeup_enable(g_buttons[i].gpio, GPIO_INTR_LOW_LEVEL);
+#endif
+    }
+#ifdef CONFIG_PM_ENABLE
+    esp_sleep_enable_gpio_wakeup();
+#endif
+    // the first tick takes the state of the buttons at boot
+    sensor_edge_t edge = {.type = SENSOR_EDGE_BUTTON};
+    __atomic_add_fetch(&g_wake_gen, 1, __ATOMIC_SEQ_CST);
+    xQueueSend(g_gpio_evt_queue, &edge, 0);
+    return ESP_OK;
+}
+
 // innit sensor
 esp_err_t sensor_init(void) {
 
-    ESP_LOGI(TAG, "init buttons");
-    button_config_t cfg1 = {
-        .type = BUTTON_TYPE_GPIO,
-        .gpio_button_config = {
-            .gpio_num = CONFIG_GPIO_BTN_1,
-            .active_level = 0,
-        },
-    };
-    button_handle_t btn1 = iot_button_create(&cfg1);
-    ESP_RETURN_ON_FALSE(btn1 != NULL, ESP_FAIL, TAG, "Button1 initialization failed.");
-
-    esp_err_t err = iot_button_register_cb(btn1, BUTTON_PRESS_DOWN,
-                                button_press_down_cb, &btn1_pressed);
-    ESP_ERROR_CHECK(err);
-
-    button_config_t cfg2 = {
-        .type = BUTTON_TYPE_GPIO,
-        .gpio_button_config = {
-            .gpio_num = CONFIG_GPIO_BTN_2,
-            .active_level = 0,
-        },
-    };
-    button_handle_t btn2 = iot_button_create(&cfg2);
-    ESP_RETURN_ON_FALSE(btn2 != NULL, ESP_FAIL, TAG, "Button2 initialization failed.");
+    // shared by the vibration sensor and the buttons
+    esp_err_t err = gpio_install_isr_service(0);
+    if (ESP_ERR_INVALID_STATE == err) {
+        err = ESP_OK;
+    }
+    ESP_RETURN_ON_ERROR(err, TAG, "GPIO interrupt service failed.");
 
-    err = iot_button_register_cb(btn2, BUTTON_PRESS_DOWN,
-                                button_press_down_cb, &btn2_pressed);
-    ESP_ERROR_CHECK(err);
+    ESP_LOGI(TAG, "init buttons");
+    err = sensor_button_init();
+    ESP_RETURN_ON_ERROR(err, TAG, "Button initialization failed.");
 
 #ifdef CONFIG_BATTERY_IN_USE
     ESP_LOGI(TAG, "init sensor");
@@ -465,5 +894,10 @@ esp_err_t sensor_init(void) {
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Register vabration sensor triggered handler failed.");
     }
+
+    err = sensor_sched_start();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Start sensor scheduler failed.");
+    }
     return err;
 }
@@ -31,10 +31,36 @@ extern "C" {
 #define EVENT_MODE_BITS     BIT1
 #define EVENT_TIMER_BITS    BIT2
 #define EVENT_COLOR_BITS    BIT3
+#define EVENT_OFF_BITS      BIT4
+// dump recorded events
+#define EVENT_DUMP_BITS     BIT5
+// vibration hit
+#define EVENT_KICK_BITS     BIT6
+// new battery sample
+#define EVENT_BATTERY_BITS  BIT7
+
+#define SENSOR_BTN_1        0
+#define SENSOR_BTN_2        1
+
+/**
+ * @brief Latest sample of every sensor, published by the scheduler
+ *
+ */
+typedef struct {
+    int32_t               battery_mv;
+    uint8_t               chrg_state;   /*!< bit1 charging, bit0 standby */
+    uint8_t                  buttons;   /*!< debounced, bit n for SENSOR_BTN_n */
+    uint8_t                vibration;   /*!< raw level of the vibration sensor */
+    uint32_t                    hits;   /*!< falling edges of the vibration sensor */
+    uint32_t                   ticks;   /*!< scheduler wake-ups */
+} sensor_values_t;
 
 // innit sensor
 esp_err_t sensor_init(void);
 
+// consistent copy of the latest sensor values
+void sensor_snapshot(sensor_values_t *values);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,158 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 22:20:40
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 22:20:43
+ * @FilePath    : /shellhome-nightlamp/main/board_stats.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <string.h>
+#include <inttypes.h>
+
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#include "board_stats.h"
+
+static const char *TAG = "STATS";
+
+#ifdef CONFIG_LAMP_STATS
+
+#include "board_mem.h"
+
+#define STATS_TASK_STACK    (3 * 1024)
+#define STATS_TASK_MAX      24
+
+/**< run time of a task at the last report */
+typedef struct {
+    TaskHandle_t              handle;
+    uint32_t                 counter;
+} stats_prev_t;
+
+MEM_TASK_DEFINE(stats, STATS_TASK_STACK);
+
+static TaskHandle_t g_stats_task = NULL;
+static TaskHandle_t g_render_task = NULL;
+/**< only touched by stats_task, static to keep them off its stack */
+static TaskStatus_t g_status[STATS_TASK_MAX];
+static stats_prev_t g_prev[STATS_TASK_MAX];
+static UBaseType_t g_prev_num = 0;
+static uint32_t g_prev_total = 0;
+
+/**< counter at the last report, 0 for a task born since */
+static uint32_t prev_counter(TaskHandle_t handle) {
+    for (UBaseType_t i = 0; i < g_prev_num; i++) {
+        if (g_prev[i].handle == handle) {
+            return g_prev[i].counter;
+        }
+    }
+    return 0;
+}
+
+static inline uint32_t permille_of(uint32_t part, uint32_t whole) {
+    uint32_t permille = whole ? (uint32_t)((uint64_t)part * 1000 / whole) : 0;
+    return permille > 1000 ? 1000 : permille;
+}
+
+static bool is_idle(TaskHandle_t handle) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (xTaskGetIdleTaskHandleForCore(core) == handle) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void stats_report(void) {
+    configRUN_TIME_COUNTER_TYPE total;
+    char idle[16 * portNUM_PROCESSORS];
+    int len = 0;
+
+    UBaseType_t num = uxTaskGetSystemState(g_status, STATS_TASK_MAX, &total);
+    if (0 == num) {
+        ESP_LOGW(TAG, "more than %d tasks, raise STATS_TASK_MAX", STATS_TASK_MAX);
+        return;
+    }
+    // run time counts in us of wall time, a share is of one core
+    uint32_t wall = (uint32_t)total - g_prev_total;
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        TaskHandle_t handle = xTaskGetIdleTaskHandleForCore(core);
+        for (UBaseType_t i = 0; i < num; i++) {
+            if (g_status[i].xHandle == handle) {
+                uint32_t permille = permille_of(g_status[i].ulRunTimeCounter - prev_counter(handle), wall);
+                len += snprintf(idle + len, sizeof(idle) - len, " core%d %"PRIu32".%"PRIu32"%%",
+                                core, permille / 10, permille % 10);
+            }
+        }
+    }
+    ESP_LOGI(TAG, "%u tasks over %"PRIu32" ms, heap free %u min %u B, idle:%s",
+             (unsigned)num, wall / 1000,
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_DEFAULT),
+             (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT), idle);
+
+    ESP_LOGI(TAG, "  %-16s prio   cpu  stack free", "task");
+    for (UBaseType_t i = 0; i < num; i++) {
+        const TaskStatus_t *st = &g_status[i];
+        if (is_idle(st->xHandle)) {
+            continue;
+        }
+        uint32_t permille = permille_of(st->ulRunTimeCounter - prev_counter(st->xHandle), wall);
+        // stacks count in bytes on ESP-IDF
+        uint32_t free = st->usStackHighWaterMark;
+        ESP_LOGI(TAG, "  %-16s %4u %3"PRIu32".%"PRIu32"%% %8"PRIu32" B", st->pcTaskName,
+                 (unsigned)st->uxCurrentPriority, permille / 10, permille % 10, free);
+        if (free < CONFIG_LAMP_STATS_STACK_MIN) {
+            ESP_LOGW(TAG, "%s has %"PRIu32" B of stack left, below %d",
+                     st->pcTaskName, free, CONFIG_LAMP_STATS_STACK_MIN);
+        }
+        if (st->xHandle == g_render_task && permille > CONFIG_LAMP_STATS_RENDER_BUDGET * 10) {
+            ESP_LOGW(TAG, "render task took %"PRIu32".%"PRIu32"%% of a core, budget %d%%",
+                     permille / 10, permille % 10, CONFIG_LAMP_STATS_RENDER_BUDGET);
+        }
+    }
+
+    for (UBaseType_t i = 0; i < num; i++) {
+        g_prev[i] = (stats_prev_t){g_status[i].xHandle, g_status[i].ulRunTimeCounter};
+    }
+    g_prev_num = num;
+    g_prev_total = total;
+}
+
+static void stats_task(void *arg) {
+    ESP_LOGI(TAG, "svc ...");
+    while (1) {
+        // on request or every report period, whichever comes first
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_LAMP_PM_REPORT_S * 1000));
+        stats_report();
+    }
+}
+
+esp_err_t board_stats_init(TaskHandle_t render) {
+    g_render_task = render;
+    mem_budget_add("stats", sizeof(g_status) + sizeof(g_prev), true);
+    // the lowest priority above idle, a busy lamp delays its report
+    g_stats_task = MEM_TASK_CREATE(stats, stats_task, "stats_task",
+                                   STATS_TASK_STACK, NULL, 1);
+    return NULL == g_stats_task ? ESP_FAIL : ESP_OK;
+}
+
+void board_stats_request(void) {
+    if (NULL != g_stats_task) {
+        xTaskNotifyGive(g_stats_task);
+    }
+}
+
+#else
+
+esp_err_t board_stats_init(TaskHandle_t render) {
+    ESP_LOGD(TAG, "stats disabled");
+    return ESP_OK;
+}
+
+void board_stats_request(void) {
+}
+
+#endif /* CONFIG_LAMP_STATS */
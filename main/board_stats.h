@@ -0,0 +1,33 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 22:20:12
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 22:20:15
+ * @FilePath    : /shellhome-nightlamp/main/board_stats.h
+ * @Description : task CPU share, stack and heap headroom, with alarms
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef BOARD_STATS_H
+#define BOARD_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+
+// start the report task, render is the task held to the CPU budget
+esp_err_t board_stats_init(TaskHandle_t render);
+
+// report now instead of at the next CONFIG_LAMP_PM_REPORT_S
+void board_stats_request(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* BOARD_STATS_H */
@@ -0,0 +1,177 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 21:48:31
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 22:52:19
+ * @FilePath    : /shellhome-nightlamp/main/board_strip.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <stdint.h>
+
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "esp_idf_version.h"
+#include "driver/rmt_tx.h"
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+#include "driver/rmt_encoder.h"
+#define STRIP_SIMPLE_ENCODER    1
+#endif
+
+#include "board_strip.h"
+#include "board_mem.h"
+#include "lamp_fx.h"
+#include "lamp_wire.h"
+
+static const char *TAG = "STRIP";
+
+/* WS2812 timing in ns, the strip latches after the line stays low */
+#define STRIP_T0H_NS        300
+#define STRIP_T0L_NS        900
+#define STRIP_T1H_NS        900
+#define STRIP_T1L_NS        300
+#define STRIP_RESET_US      280
+#define STRIP_MEM_SYMBOLS   128         /**< two blocks, the ISR refills one half at a time */
+#define STRIP_WAIT_MS       100
+
+typedef struct {
+    rmt_channel_handle_t    channel;
+    rmt_encoder_handle_t    encoder;
+    int64_t                  done_us;   /*!< end of the last frame, set from the ISR */
+    lamp_wire_t                 wire;   /*!< symbols and output curve */
+} board_strip_t;
+
+/**< one frame in flight, read by the encoder while it is sent */
+typedef struct {
+    const lamp_rgb_t            *rgb;
+    const lamp_layout_t      *layout;
+} strip_job_t;
+
+static board_strip_t g_strip;
+
+static inline uint16_t ns_to_ticks(uint32_t ns) {
+    return (uint64_t)CONFIG_LED_STRIP_RESOLUTION_HZ * ns / 1000000000ULL;
+}
+
+static bool strip_done_cb(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata,
+                          void *ctx) {
+    __atomic_store_n(&g_strip.done_us, esp_timer_get_time(), __ATOMIC_RELEASE);
+    return false;
+}
+
+#ifdef STRIP_SIMPLE_ENCODER
+
+/**< called from the RMT ISR as its memory drains, whole LEDs at a time */
+static size_t strip_encode_cb(const void *data, size_t data_size, size_t symbols_written,
+                              size_t symbols_free, rmt_symbol_word_t *symbols, bool *done,
+                              void *arg) {
+    const strip_job_t *job = data;
+    uint16_t span = job->layout->span;
+    uint16_t first = symbols_written / LAMP_WIRE_LED_SYMBOLS;
+    uint16_t num = symbols_free / LAMP_WIRE_LED_SYMBOLS;
+
+    num = num > span - first ? span - first : num;
+    lamp_wire_encode(&g_strip.wire, job->rgb,
+                     job->layout->in_order ? NULL : job->layout->logical,
+                     first, num, (uint32_t *)symbols);
+    *done = first + num >= span;
+    return num * LAMP_WIRE_LED_SYMBOLS;
+}
+
+static esp_err_t strip_encoder_new(void) {
+    rmt_simple_encoder_config_t config = {
+        .callback = strip_encode_cb,
+        .arg = NULL,
+        .min_chunk_size = LAMP_WIRE_LED_SYMBOLS,
+    };
+    return rmt_new_simple_encoder(&config, &g_strip.encoder);
+}
+
+#else
+
+/**< wire format for the bytes encoder of older IDF, sized for the most LEDs */
+static uint8_t g_strip_buf[LAMP_STRIP_MAX * LAMP_PACK_BYTES];
+
+static esp_err_t strip_encoder_new(void) {
+    rmt_bytes_encoder_config_t config = {
+        .bit0.val = g_strip.wire.bit0,
+        .bit1.val = g_strip.wire.bit1,
+        .flags.msb_first = 1,
+    };
+    mem_budget_add("strip_buf", sizeof(g_strip_buf), true);
+    return rmt_new_bytes_encoder(&config, &g_strip.encoder);
+}
+
+#endif /* STRIP_SIMPLE_ENCODER */
+
+esp_err_t board_strip_init(int gpio) {
+    mem_budget_add("strip", sizeof(g_strip), true);
+
+    rmt_tx_channel_config_t channel_config = {
+        .gpio_num = gpio,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = CONFIG_LED_STRIP_RESOLUTION_HZ,
+        .mem_block_symbols = STRIP_MEM_SYMBOLS,
+        .trans_queue_depth = 1,
+    };
+    ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&channel_config, &g_strip.channel),
+                        TAG, "rmt channel failed");
+
+    rmt_symbol_word_t bit0 = {
+        .level0 = 1, .duration0 = ns_to_ticks(STRIP_T0H_NS),
+        .level1 = 0, .duration1 = ns_to_ticks(STRIP_T0L_NS),
+    };
+    rmt_symbol_word_t bit1 = {
+        .level0 = 1, .duration0 = ns_to_ticks(STRIP_T1H_NS),
+        .level1 = 0, .duration1 = ns_to_ticks(STRIP_T1L_NS),
+    };
+    lamp_wire_init(&g_strip.wire, bit0.val, bit1.val, CONFIG_LAMP_STRIP_BRIGHTNESS);
+    ESP_RETURN_ON_ERROR(strip_encoder_new(), TAG, "rmt encoder failed");
+
+    rmt_tx_event_callbacks_t cbs = {.on_trans_done = strip_done_cb};
+    ESP_RETURN_ON_ERROR(rmt_tx_register_event_callbacks(g_strip.channel, &cbs, NULL),
+                        TAG, "rmt callback failed");
+    ESP_LOGI(TAG, "%d LEDs at most on GPIO %d, brightness %d", LAMP_STRIP_MAX, gpio,
+             CONFIG_LAMP_STRIP_BRIGHTNESS);
+    return ESP_OK;
+}
+
+esp_err_t board_strip_show(const lamp_rgb_t *rgb, const lamp_layout_t *layout) {
+    static const rmt_transmit_config_t tx_config = {
+        .loop_count = 0,
+        .flags.eot_level = 0,
+    };
+    strip_job_t job = {.rgb = rgb, .layout = layout};
+    const void *payload = &job;
+    size_t size = sizeof(job);
+
+#ifndef STRIP_SIMPLE_ENCODER
+    lamp_fx_kernels()->pack_grb(g_strip_buf, LAMP_STRIP_MAX, rgb,
+                                layout->in_order ? NULL : layout->phys, layout->num);
+    for (uint32_t i = 0; i < layout->span * LAMP_PACK_BYTES; i++) {
+        g_strip_buf[i] = g_strip.wire.table[g_strip_buf[i]];
+    }
+    payload = g_strip_buf;
+    size = layout->span * LAMP_PACK_BYTES;
+#endif
+
+    // a frame right after another would run into it before the strip latched
+    int64_t wait = __atomic_load_n(&g_strip.done_us, __ATOMIC_ACQUIRE) + STRIP_RESET_US
+                   - esp_timer_get_time();
+    if (wait > 0) {
+        esp_rom_delay_us(wait);
+    }
+
+    // enabled only while sending, an enabled channel holds a PM lock
+    ESP_RETURN_ON_ERROR(rmt_enable(g_strip.channel), TAG, "rmt enable failed");
+    esp_err_t err = rmt_transmit(g_strip.channel, g_strip.encoder, payload, size, &tx_config);
+    if (ESP_OK == err) {
+        // the encoder reads rgb until the end, 30 us per LED
+        err = rmt_tx_wait_all_done(g_strip.channel, STRIP_WAIT_MS);
+    }
+    rmt_disable(g_strip.channel);
+    return err;
+}
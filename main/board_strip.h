@@ -0,0 +1,36 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 21:48:05
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 22:52:08
+ * @FilePath    : /shellhome-nightlamp/main/board_strip.h
+ * @Description : WS2812 strip on RMT, the encoder turns lamp frames into
+ *                symbols as they are sent
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef BOARD_STRIP_H
+#define BOARD_STRIP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "lamp_frame.h"
+#include "lamp_layout.h"
+
+// install the RMT channel for at most LAMP_STRIP_MAX LEDs on gpio
+esp_err_t board_strip_init(int gpio);
+
+// send rgb in the wiring order of layout, returns once it is out
+esp_err_t board_strip_show(const lamp_rgb_t *rgb, const lamp_layout_t *layout);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* BOARD_STRIP_H */
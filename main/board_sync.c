@@ -0,0 +1,188 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 20:34:40
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 20:34:43
+ * @FilePath    : /shellhome-nightlamp/main/board_sync.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+
+#include "board_sync.h"
+
+static const char *TAG = "SYNC";
+
+#ifdef CONFIG_LAMP_SYNC
+
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_wifi.h"
+#include "esp_now.h"
+#include "esp_mac.h"
+
+#include "board_mem.h"
+#include "lamp_sync.h"
+
+#define SYNC_TASK_STACK     (3 * 1024)
+#define SYNC_QUEUE_LEN      8
+
+/**< one received packet, stamped in the receive callback */
+typedef struct {
+    int64_t                 local_us;
+    uint8_t                      len;
+    uint8_t data[LAMP_SYNC_PKT_MAX];
+} sync_rx_t;
+
+MEM_TASK_DEFINE(sync, SYNC_TASK_STACK);
+MEM_QUEUE_DEFINE(sync, SYNC_QUEUE_LEN, sizeof(sync_rx_t));
+
+static QueueHandle_t g_sync_queue = NULL;
+/**< protocol state, only touched by sync_task */
+static lamp_sync_t g_sync;
+/**< applied offset, published to the renderer */
+static int32_t g_sync_offset_ms = 0;
+
+static const uint8_t g_broadcast[ESP_NOW_ETH_ALEN] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+static int espnow_send(void *ctx, const uint8_t *buf, size_t len) {
+    return ESP_OK == esp_now_send(g_broadcast, buf, len) ? 0 : -1;
+}
+
+static int64_t espnow_now(void *ctx) {
+    return esp_timer_get_time();
+}
+
+static const lamp_sync_transport_t g_espnow = {
+    .send = espnow_send,
+    .now  = espnow_now,
+    .ctx  = NULL,
+};
+
+static void espnow_recv_cb(const esp_now_recv_info_t *info, const uint8_t *data, int len) {
+    // stamp before anything else, queueing delay must not count as flight
+    sync_rx_t rx = {.local_us = esp_timer_get_time()};
+
+    if (len <= 0 || len > LAMP_SYNC_PKT_MAX) {
+        return;
+    }
+    rx.len = len;
+    memcpy(rx.data, data, len);
+    xQueueSend(g_sync_queue, &rx, 0);
+}
+
+static void sync_report(void) {
+    const lamp_sync_stats_t *st = &g_sync.stats;
+    ESP_LOGI(TAG, "%s offset %"PRId64" us, sent %"PRIu32" received %"PRIu32
+             " answered %"PRIu32" samples %"PRIu32" steps %"PRIu32" dropped %"PRIu32,
+             LAMP_SYNC_MASTER == g_sync.role ? "master" : (g_sync.locked ? "locked" : "searching"),
+             g_sync.offset_us, st->sent, st->received, st->answered, st->samples,
+             st->steps, st->dropped);
+}
+
+static void sync_task(void *arg) {
+    const int64_t period_us = CONFIG_LAMP_SYNC_PERIOD_MS * 1000LL;
+    int64_t poll_us = esp_timer_get_time();
+    int64_t report_us = poll_us;
+    sync_rx_t rx;
+
+    ESP_LOGI(TAG, "svc ...");
+    while (1) {
+        int64_t now = esp_timer_get_time();
+        if (now >= poll_us) {
+            lamp_sync_poll(&g_sync);
+            poll_us = now + period_us;
+        }
+        if (now - report_us >= CONFIG_LAMP_PM_REPORT_S * 1000000LL) {
+            sync_report();
+            report_us = now;
+        }
+
+        TickType_t wait = pdMS_TO_TICKS((poll_us - now) / 1000);
+        if (pdTRUE != xQueueReceive(g_sync_queue, &rx, wait ? wait : 1)) {
+            continue;
+        }
+        if (lamp_sync_input(&g_sync, rx.data, rx.len, rx.local_us)) {
+            __atomic_store_n(&g_sync_offset_ms, (int32_t)(g_sync.offset_us / 1000),
+                             __ATOMIC_RELEASE);
+            ESP_LOGD(TAG, "offset %"PRId64" us", g_sync.offset_us);
+        }
+    }
+}
+
+static esp_err_t espnow_init(void) {
+    ESP_RETURN_ON_ERROR(esp_netif_init(), TAG, "netif init failed");
+    esp_err_t err = esp_event_loop_create_default();
+    ESP_RETURN_ON_FALSE(ESP_OK == err || ESP_ERR_INVALID_STATE == err, err, TAG,
+                        "event loop failed");
+
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    ESP_RETURN_ON_ERROR(esp_wifi_init(&cfg), TAG, "wifi init failed");
+    ESP_RETURN_ON_ERROR(esp_wifi_set_storage(WIFI_STORAGE_RAM), TAG, "wifi storage failed");
+    ESP_RETURN_ON_ERROR(esp_wifi_set_mode(WIFI_MODE_STA), TAG, "wifi mode failed");
+    ESP_RETURN_ON_ERROR(esp_wifi_start(), TAG, "wifi start failed");
+    ESP_RETURN_ON_ERROR(esp_wifi_set_channel(CONFIG_LAMP_SYNC_CHANNEL, WIFI_SECOND_CHAN_NONE),
+                        TAG, "wifi channel failed");
+
+    ESP_RETURN_ON_ERROR(esp_now_init(), TAG, "esp-now init failed");
+    ESP_RETURN_ON_ERROR(esp_now_register_recv_cb(espnow_recv_cb), TAG, "esp-now recv failed");
+    esp_now_peer_info_t peer = {
+        .channel = CONFIG_LAMP_SYNC_CHANNEL,
+        .ifidx = WIFI_IF_STA,
+        .encrypt = false,
+    };
+    memcpy(peer.peer_addr, g_broadcast, ESP_NOW_ETH_ALEN);
+    return esp_now_add_peer(&peer);
+}
+
+esp_err_t board_sync_init(void) {
+    uint8_t mac[6];
+
+    g_sync_queue = MEM_QUEUE_CREATE(sync, "sync_queue", SYNC_QUEUE_LEN, sizeof(sync_rx_t));
+    ESP_RETURN_ON_FALSE(NULL != g_sync_queue, ESP_ERR_NO_MEM, TAG, "sync queue failed");
+    ESP_RETURN_ON_ERROR(espnow_init(), TAG, "esp-now failed");
+
+    // the low bytes of the MAC tell lamps apart
+    ESP_RETURN_ON_ERROR(esp_read_mac(mac, ESP_MAC_WIFI_STA), TAG, "read mac failed");
+    uint32_t node = (uint32_t)mac[2] << 24 | mac[3] << 16 | mac[4] << 8 | mac[5];
+#ifdef CONFIG_LAMP_SYNC_MASTER
+    lamp_sync_init(&g_sync, LAMP_SYNC_MASTER, node, &g_espnow);
+#else
+    lamp_sync_init(&g_sync, LAMP_SYNC_SLAVE, node, &g_espnow);
+#endif
+    ESP_LOGI(TAG, "node %08"PRIx32" %s on channel %d", node,
+             LAMP_SYNC_MASTER == g_sync.role ? "master" : "follower",
+             CONFIG_LAMP_SYNC_CHANNEL);
+
+    TaskHandle_t task = MEM_TASK_CREATE(sync, sync_task, "sync_task",
+                                        SYNC_TASK_STACK, NULL, 3);
+    return NULL == task ? ESP_FAIL : ESP_OK;
+}
+
+uint32_t board_sync_now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000)
+           + (uint32_t)__atomic_load_n(&g_sync_offset_ms, __ATOMIC_ACQUIRE);
+}
+
+#else
+
+esp_err_t board_sync_init(void) {
+    ESP_LOGD(TAG, "sync disabled");
+    return ESP_OK;
+}
+
+uint32_t board_sync_now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+#endif /* CONFIG_LAMP_SYNC */
@@ -0,0 +1,33 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 20:34:18
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 20:34:21
+ * @FilePath    : /shellhome-nightlamp/main/board_sync.h
+ * @Description : shared animation clock between lamps over ESP-NOW
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef BOARD_SYNC_H
+#define BOARD_SYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+// bring up ESP-NOW and the sync task, nothing without CONFIG_LAMP_SYNC
+esp_err_t board_sync_init(void);
+
+// shared time in ms, the local time until locked to the master
+uint32_t board_sync_now_ms(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* BOARD_SYNC_H */
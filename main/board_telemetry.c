@@ -0,0 +1,275 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 23:41:30
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 23:41:33
+ * @FilePath    : /shellhome-nightlamp/main/board_telemetry.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_idf_version.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "board_telemetry.h"
+
+static const char *TAG = "TELEMETRY";
+
+#ifdef CONFIG_LAMP_TELEMETRY
+
+#include "board_mem.h"
+#include "board_sensor.h"
+#ifdef CONFIG_LAMP_TELEMETRY_UART
+#include "driver/uart.h"
+#elif ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+#include "driver/uart_vfs.h"
+#else
+#include "esp_vfs_dev.h"
+#endif
+
+#define TELEMETRY_TASK_STACK    (3 * 1024)
+#define TELEMETRY_UART_TX_BUF   1024
+#define TELEMETRY_UART_RX_BUF   256     /**< the driver wants more than the FIFO */
+
+/**< version, seq, records and crc, COBS adds one byte and the delimiters two */
+#define TELEMETRY_PAYLOAD_MAX   (2 + TELEMETRY_FRAME_RECORDS * sizeof(telemetry_record_t) + 2)
+#define TELEMETRY_WIRE_MAX      (TELEMETRY_PAYLOAD_MAX + 3)
+
+_Static_assert(sizeof(telemetry_record_t) == 16, "the decoder expects 16 byte records");
+_Static_assert(TELEMETRY_PAYLOAD_MAX < 254, "a frame must fit one COBS block");
+
+/**< frames of the current period, written by the render task */
+typedef struct {
+    uint32_t                  frames;
+    uint32_t                    mode;
+    uint64_t                 busy_us;
+    uint32_t                  max_us;
+} telemetry_frames_t;
+
+MEM_TASK_DEFINE(telemetry, TELEMETRY_TASK_STACK);
+
+static telemetry_record_t g_ring[CONFIG_LAMP_TELEMETRY_NUM];
+/**< head + 1 of the record in each slot once written, 0 while it is written */
+static uint32_t g_ring_seq[CONFIG_LAMP_TELEMETRY_NUM];
+static uint32_t g_ring_head = 0;        /**< records ever added */
+static uint32_t g_ring_tail = 0;        /**< records ever taken, task only */
+static telemetry_frames_t g_frames;
+static portMUX_TYPE g_frames_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t g_seq = 0;
+
+void board_telemetry_add(uint8_t type, uint8_t a, uint16_t b, uint32_t c, uint32_t d) {
+    uint32_t head = __atomic_fetch_add(&g_ring_head, 1, __ATOMIC_RELAXED);
+    uint32_t slot = head % CONFIG_LAMP_TELEMETRY_NUM;
+    telemetry_record_t *rec = &g_ring[slot];
+
+    __atomic_store_n(&g_ring_seq[slot], 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    rec->ts_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    rec->type = type;
+    rec->a = a;
+    rec->b = b;
+    rec->c = c;
+    rec->d = d;
+    // written last, the reader takes the slot only for its own sequence
+    __atomic_store_n(&g_ring_seq[slot], head + 1, __ATOMIC_RELEASE);
+}
+
+void board_telemetry_frame(uint32_t mode, uint32_t busy_us) {
+    taskENTER_CRITICAL(&g_frames_lock);
+    g_frames.frames++;
+    g_frames.mode = mode;
+    g_frames.busy_us += busy_us;
+    g_frames.max_us = busy_us > g_frames.max_us ? busy_us : g_frames.max_us;
+    taskEXIT_CRITICAL(&g_frames_lock);
+}
+
+/**< CRC-16/CCITT-FALSE, a few hundred bytes per period */
+static uint16_t telemetry_crc(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xffff;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/**< delimiter, COBS of a payload below 254 bytes, delimiter */
+static size_t telemetry_cobs(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t code_at = 1;
+    size_t at = 2;
+
+    out[0] = 0;
+    out[code_at] = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i]) {
+            out[at++] = in[i];
+            out[code_at]++;
+        } else {
+            code_at = at++;
+            out[code_at] = 1;
+        }
+    }
+    out[at++] = 0;
+    return at;
+}
+
+static void telemetry_write(const uint8_t *data, size_t len) {
+#ifdef CONFIG_LAMP_TELEMETRY_UART
+    // copied into the driver ring, the UART drains it by interrupt
+    uart_write_bytes(CONFIG_LAMP_TELEMETRY_UART_NUM, data, len);
+#else
+    // one locked write, log lines can't land inside the frame
+    fwrite(data, 1, len, stdout);
+    fflush(stdout);
+#endif
+}
+
+static void telemetry_send(const telemetry_record_t *records, uint32_t num) {
+    static uint8_t payload[TELEMETRY_PAYLOAD_MAX];
+    static uint8_t wire[TELEMETRY_WIRE_MAX];
+    size_t len = 0;
+
+    payload[len++] = TELEMETRY_VERSION;
+    payload[len++] = g_seq++;
+    memcpy(payload + len, records, num * sizeof(telemetry_record_t));
+    len += num * sizeof(telemetry_record_t);
+    uint16_t crc = telemetry_crc(payload, len);
+    payload[len++] = crc & 0xff;
+    payload[len++] = crc >> 8;
+    telemetry_write(wire, telemetry_cobs(payload, len, wire));
+}
+
+/**< queue the samples of this period, then send the ring in frames */
+static void telemetry_period(void) {
+    static telemetry_record_t records[TELEMETRY_FRAME_RECORDS];
+    telemetry_frames_t frames;
+
+#ifdef CONFIG_BATTERY_IN_USE
+    sensor_values_t values;
+    sensor_snapshot(&values);
+    board_telemetry_add(TELEMETRY_BATTERY, values.chrg_state, values.battery_mv, 0, 0);
+#endif
+
+    taskENTER_CRITICAL(&g_frames_lock);
+    frames = g_frames;
+    memset(&g_frames, 0, sizeof(g_frames));
+    taskEXIT_CRITICAL(&g_frames_lock);
+    if (frames.frames) {
+        board_telemetry_add(TELEMETRY_FRAMES, frames.mode, frames.frames,
+                            (uint32_t)(frames.busy_us / frames.frames), frames.max_us);
+    }
+
+    uint32_t head = __atomic_load_n(&g_ring_head, __ATOMIC_ACQUIRE);
+    uint32_t num = 0;
+    if (head - g_ring_tail > CONFIG_LAMP_TELEMETRY_NUM) {
+        records[num++] = (telemetry_record_t){
+            .ts_ms = (uint32_t)(esp_timer_get_time() / 1000),
+            .type = TELEMETRY_LOST,
+            .c = head - g_ring_tail - CONFIG_LAMP_TELEMETRY_NUM,
+        };
+        g_ring_tail = head - CONFIG_LAMP_TELEMETRY_NUM;
+    }
+    while (g_ring_tail != head) {
+        uint32_t slot = g_ring_tail % CONFIG_LAMP_TELEMETRY_NUM;
+        if (g_ring_tail + 1 != __atomic_load_n(&g_ring_seq[slot], __ATOMIC_ACQUIRE)) {
+            // still being written or already reused, next period sorts it out
+            break;
+        }
+        records[num] = g_ring[slot];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (g_ring_tail + 1 != __atomic_load_n(&g_ring_seq[slot], __ATOMIC_RELAXED)) {
+            // overwritten while copied, counted as lost next period
+            break;
+        }
+        num++;
+        g_ring_tail++;
+        if (TELEMETRY_FRAME_RECORDS == num) {
+            telemetry_send(records, num);
+            num = 0;
+        }
+    }
+    if (num) {
+        telemetry_send(records, num);
+    }
+}
+
+static void telemetry_task(void *arg) {
+    TickType_t wake = xTaskGetTickCount();
+
+    ESP_LOGI(TAG, "svc ...");
+    while (1) {
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(CONFIG_LAMP_TELEMETRY_PERIOD_MS));
+        telemetry_period();
+    }
+}
+
+esp_err_t board_telemetry_init(void) {
+#ifdef CONFIG_LAMP_TELEMETRY_UART
+    uart_config_t uart_cfg = {
+        .baud_rate = CONFIG_LAMP_TELEMETRY_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    esp_err_t err = uart_driver_install(CONFIG_LAMP_TELEMETRY_UART_NUM, TELEMETRY_UART_RX_BUF,
+                                        TELEMETRY_UART_TX_BUF, 0, NULL, 0);
+    if (ESP_OK == err) {
+        err = uart_param_config(CONFIG_LAMP_TELEMETRY_UART_NUM, &uart_cfg);
+    }
+    if (ESP_OK == err) {
+        err = uart_set_pin(CONFIG_LAMP_TELEMETRY_UART_NUM, CONFIG_LAMP_TELEMETRY_TX_GPIO,
+                           UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    }
+    if (ESP_OK != err) {
+        ESP_LOGE(TAG, "uart %d failed: %s", CONFIG_LAMP_TELEMETRY_UART_NUM, esp_err_to_name(err));
+        return err;
+    }
+    mem_budget_add("telemetry uart", TELEMETRY_UART_TX_BUF + TELEMETRY_UART_RX_BUF, false);
+    ESP_LOGI(TAG, "uart %d tx gpio %d at %d baud, every %d ms", CONFIG_LAMP_TELEMETRY_UART_NUM,
+             CONFIG_LAMP_TELEMETRY_TX_GPIO, CONFIG_LAMP_TELEMETRY_BAUD,
+             CONFIG_LAMP_TELEMETRY_PERIOD_MS);
+#else
+    // newlib turns every 0x0a into 0x0d 0x0a by default, which breaks any
+    // frame holding that byte; the console sends bytes as they are from now
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+    uart_vfs_dev_port_set_tx_line_endings(CONFIG_ESP_CONSOLE_UART_NUM, ESP_LINE_ENDINGS_LF);
+#else
+    esp_vfs_dev_uart_port_set_tx_line_endings(CONFIG_ESP_CONSOLE_UART_NUM, ESP_LINE_ENDINGS_LF);
+#endif
+    ESP_LOGI(TAG, "console every %d ms, LF line endings", CONFIG_LAMP_TELEMETRY_PERIOD_MS);
+#endif
+
+    mem_budget_add("telemetry", sizeof(g_ring) + sizeof(g_ring_seq) + TELEMETRY_PAYLOAD_MAX + TELEMETRY_WIRE_MAX
+                   + TELEMETRY_FRAME_RECORDS * sizeof(telemetry_record_t), true);
+    // the lowest priority above idle, a late period only batches more
+    TaskHandle_t task = MEM_TASK_CREATE(telemetry, telemetry_task, "telemetry",
+                                        TELEMETRY_TASK_STACK, NULL, 1);
+    return NULL == task ? ESP_FAIL : ESP_OK;
+}
+
+#else
+
+esp_err_t board_telemetry_init(void) {
+    ESP_LOGD(TAG, "telemetry disabled");
+    return ESP_OK;
+}
+
+void board_telemetry_add(uint8_t type, uint8_t a, uint16_t b, uint32_t c, uint32_t d) {
+}
+
+void board_telemetry_frame(uint32_t mode, uint32_t busy_us) {
+}
+
+#endif /* CONFIG_LAMP_TELEMETRY */
@@ -0,0 +1,83 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 23:41:08
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 23:41:11
+ * @FilePath    : /shellhome-nightlamp/main/board_telemetry.h
+ * @Description : framed binary telemetry over the console or a UART,
+ *                decoded on the host by tools/telemetry_decode.py
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef BOARD_TELEMETRY_H
+#define BOARD_TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+/*
+ * Every CONFIG_LAMP_TELEMETRY_PERIOD_MS the queued records go out as one
+ * frame, little endian:
+ *   0x00  COBS(version:u8 seq:u8 records crc:u16)  0x00
+ * The crc is CRC-16/CCITT-FALSE over version, seq and the records. Zero
+ * bytes only delimit frames, so log lines sharing the console fall between
+ * two delimiters and fail the crc on the host.
+ */
+#define TELEMETRY_VERSION       1
+#define TELEMETRY_FRAME_RECORDS 15      /**< 240 bytes of records, one COBS block */
+
+/**
+ * @brief Record types, tools/telemetry_decode.py reads the names and the
+ *        field comments from this enum so keep one type per line
+ *
+ */
+typedef enum {
+    TELEMETRY_NONE,
+    TELEMETRY_BATTERY,          /*!< a: charge (bit1 CHRG, bit0 STBY pin), b: mV */
+    TELEMETRY_VIBRATION,        /*!< c: hits (since boot) */
+    TELEMETRY_FRAMES,           /*!< a: mode, b: frames, c: busy avg us, d: busy max us */
+    TELEMETRY_LOST,             /*!< c: lost (records dropped on a full ring) */
+    TELEMETRY_TIER,             /*!< a: tier (lamp_tier_level_t), b: soc (%), c: changes */
+    TELEMETRY_BUTT
+} telemetry_type_t;
+
+/**
+ * @brief One record, 16 bytes on the wire as in memory
+ *
+ */
+typedef struct {
+    uint32_t                   ts_ms;
+    uint8_t                     type;   /*!< telemetry_type_t */
+    uint8_t                        a;
+    uint16_t                       b;
+    uint32_t                       c;
+    uint32_t                       d;
+} telemetry_record_t;
+
+#ifdef CONFIG_LAMP_TELEMETRY
+#define TELEMETRY(type, a, b, c, d) board_telemetry_add((type), (a), (b), (c), (d))
+#else
+#define TELEMETRY(type, a, b, c, d)
+#endif
+
+// start the telemetry task and its sink
+esp_err_t board_telemetry_init(void);
+
+// queue a record, lock free and safe from any task
+void board_telemetry_add(uint8_t type, uint8_t a, uint16_t b, uint32_t c, uint32_t d);
+
+// account one rendered frame, called by the render task only
+void board_telemetry_frame(uint32_t mode, uint32_t busy_us);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* BOARD_TELEMETRY_H */
@@ -0,0 +1,96 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 18:10:22
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 18:10:25
+ * @FilePath    : /shellhome-nightlamp/main/board_trace.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+
+#include "board_trace.h"
+
+static const char *TAG = "TRACE";
+
+#ifdef CONFIG_LAMP_TRACE
+
+static trace_record_t g_trace[CONFIG_LAMP_TRACE_NUM];
+/**< head + 1 of the record in each slot once written, 0 while it is written */
+static uint32_t g_trace_seq[CONFIG_LAMP_TRACE_NUM];
+static uint32_t g_trace_head = 0;       /**< records ever added */
+static uint32_t g_trace_tail = 0;       /**< records ever dumped, dump only */
+
+void IRAM_ATTR board_trace_add(uint16_t event, uint32_t a0, uint32_t a1) {
+    uint32_t head = __atomic_fetch_add(&g_trace_head, 1, __ATOMIC_RELAXED);
+    uint32_t slot = head % CONFIG_LAMP_TRACE_NUM;
+    trace_record_t *rec = &g_trace[slot];
+
+    __atomic_store_n(&g_trace_seq[slot], 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    rec->ts_us = (uint32_t)esp_timer_get_time();
+    rec->event = event;
+    rec->core = esp_cpu_get_core_id();
+    rec->a0 = a0;
+    rec->a1 = a1;
+    // written last, the dump takes the slot only for its own sequence
+    __atomic_store_n(&g_trace_seq[slot], head + 1, __ATOMIC_RELEASE);
+}
+
+void board_trace_dump(void) {
+    uint32_t head = __atomic_load_n(&g_trace_head, __ATOMIC_ACQUIRE);
+    uint32_t from = head - g_trace_tail > CONFIG_LAMP_TRACE_NUM
+                    ? head - CONFIG_LAMP_TRACE_NUM : g_trace_tail;
+    uint32_t dropped = 0;
+
+    ESP_LOGI(TAG, "trace dump: %"PRIu32" records, %"PRIu32" lost",
+             head - from, from - g_trace_tail);
+    for (uint32_t i = from; i != head; i++) {
+        uint32_t slot = i % CONFIG_LAMP_TRACE_NUM;
+        if (i + 1 != __atomic_load_n(&g_trace_seq[slot], __ATOMIC_ACQUIRE)) {
+            dropped++;
+            continue;
+        }
+        trace_record_t rec = g_trace[slot];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (i + 1 != __atomic_load_n(&g_trace_seq[slot], __ATOMIC_RELAXED)) {
+            // a wrapping writer took the slot while it was copied
+            dropped++;
+            continue;
+        }
+        // one line per record: ts event core a0 a1, all hex
+        printf("TRC %08"PRIx32" %04x %x %08"PRIx32" %08"PRIx32"\n", rec.ts_us,
+               rec.event, rec.core, rec.a0, rec.a1);
+    }
+    ESP_LOGI(TAG, "trace dump end, %"PRIu32" overwritten while dumped", dropped);
+
+    // the writers never stop, the next dump starts where this one ended
+    g_trace_tail = head;
+}
+
+size_t board_trace_size(void) {
+    return sizeof(g_trace) + sizeof(g_trace_seq);
+}
+
+#else
+
+void board_trace_add(uint16_t event, uint32_t a0, uint32_t a1) {
+}
+
+void board_trace_dump(void) {
+    ESP_LOGW(TAG, "trace disabled");
+}
+
+size_t board_trace_size(void) {
+    return 0;
+}
+
+#endif /* CONFIG_LAMP_TRACE */
@@ -0,0 +1,77 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 18:10:05
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 18:10:08
+ * @FilePath    : /shellhome-nightlamp/main/board_trace.h
+ * @Description : binary trace ring, decoded on the host by
+ *                tools/trace_decode.py
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef BOARD_TRACE_H
+#define BOARD_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+/**
+ * @brief Trace events, tools/trace_decode.py reads the names and the
+ *        argument comments from this enum so keep one event per line
+ *
+ */
+typedef enum {
+    TRACE_NONE,
+    TRACE_GESTURE,              /*!< a0: lamp_gesture_t, a1: vibration hits */
+    TRACE_BUTTON,               /*!< a0: button, a1: 0 press, 1 long press */
+    TRACE_CTRL,                 /*!< a0: lamp_ctrl_type_t, a1: actions */
+    TRACE_PARAMS,               /*!< a0: power << 8 | mode, a1: hue << 16 | saturation << 8 | value */
+    TRACE_SAVE_TIMER,           /*!< a0: 1 created, 0 restarted */
+    TRACE_OFF_TIMER,            /*!< a0: 1 created, 0 restarted */
+    TRACE_SAVE_STATE,           /*!< a0: esp_err_t of the commit, a1: us spent in NVS */
+    TRACE_BATTERY,              /*!< a0: mV, a1: charge state */
+    TRACE_BUTT
+} trace_event_t;
+
+/**
+ * @brief One trace record, 16 bytes
+ *
+ */
+typedef struct {
+    uint32_t                   ts_us;   /*!< esp_timer time, wraps after 71 min */
+    uint16_t                   event;   /*!< trace_event_t */
+    uint8_t                     core;
+    uint8_t                     rsvd;
+    uint32_t                      a0;
+    uint32_t                      a1;
+} trace_record_t;
+
+#ifdef CONFIG_LAMP_TRACE
+#define TRACE(event, a0, a1)    board_trace_add((event), (uint32_t)(a0), (uint32_t)(a1))
+#else
+#define TRACE(event, a0, a1)
+#endif
+
+// append a record, lock free and safe from any task or ISR
+void board_trace_add(uint16_t event, uint32_t a0, uint32_t a1);
+
+// print the records since the last dump oldest first as TRC lines
+void board_trace_dump(void);
+
+// bytes of the ring, 0 when disabled
+size_t board_trace_size(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* BOARD_TRACE_H */
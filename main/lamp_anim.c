@@ -0,0 +1,155 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 21:10:51
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 21:10:54
+ * @FilePath    : /shellhome-nightlamp/main/lamp_anim.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <string.h>
+#include <stdbool.h>
+
+#include "lamp_anim.h"
+
+static size_t mem_read(void *ctx, uint8_t *buf, size_t len) {
+    lamp_anim_mem_t *mem = ctx;
+    size_t left = mem->len - mem->pos;
+
+    len = len < left ? len : left;
+    memcpy(buf, mem->data + mem->pos, len);
+    mem->pos += len;
+    return len;
+}
+
+void lamp_anim_mem_source(lamp_anim_mem_t *mem, const uint8_t *data, size_t len,
+                          lamp_anim_source_t *src) {
+    mem->data = data;
+    mem->len = len;
+    mem->pos = 0;
+    src->read = mem_read;
+    src->ctx = mem;
+}
+
+/**< refill the read ahead, false at the end of the source */
+static bool anim_fill(lamp_anim_t *anim) {
+    anim->len = anim->src.read(anim->src.ctx, anim->buf, LAMP_ANIM_BUF);
+    anim->pos = 0;
+    return anim->len > 0;
+}
+
+static inline bool anim_byte(lamp_anim_t *anim, uint8_t *b) {
+    if (anim->pos >= anim->len && !anim_fill(anim)) {
+        return false;
+    }
+    *b = anim->buf[anim->pos++];
+    return true;
+}
+
+static bool anim_bytes(lamp_anim_t *anim, uint8_t *out, size_t len) {
+    while (len) {
+        if (anim->pos >= anim->len && !anim_fill(anim)) {
+            return false;
+        }
+        size_t n = anim->len - anim->pos;
+        n = n < len ? n : len;
+        memcpy(out, anim->buf + anim->pos, n);
+        anim->pos += n;
+        out += n;
+        len -= n;
+    }
+    return true;
+}
+
+lamp_anim_status_t lamp_anim_open(lamp_anim_t *anim, const lamp_anim_source_t *src) {
+    uint8_t hdr[LAMP_ANIM_HDR_LEN];
+
+    memset(anim, 0, sizeof(lamp_anim_t));
+    anim->src = *src;
+    if (!anim_bytes(anim, hdr, sizeof(hdr)) || 0 != memcmp(hdr, "LANM", 4)
+        || LAMP_ANIM_VERSION != hdr[4]) {
+        return LAMP_ANIM_ERROR;
+    }
+    uint16_t flags = hdr[14] | (hdr[15] << 8);
+    anim->info.pal_num = (flags & LAMP_ANIM_FLAG_PAL256) ? 256 : hdr[5];
+    anim->info.leds = hdr[6] | (hdr[7] << 8);
+    anim->info.frame_ms = hdr[8] | (hdr[9] << 8);
+    anim->info.frames = hdr[10] | (hdr[11] << 8) | (hdr[12] << 16) | ((uint32_t)hdr[13] << 24);
+
+    for (uint16_t i = 0; i < anim->info.pal_num; i++) {
+        if (!anim_bytes(anim, &anim->pal[i].r, 1) || !anim_bytes(anim, &anim->pal[i].g, 1)
+            || !anim_bytes(anim, &anim->pal[i].b, 1)) {
+            return LAMP_ANIM_ERROR;
+        }
+    }
+    return LAMP_ANIM_OK;
+}
+
+static inline void put_run(lamp_rgb_t *strip, uint16_t num, uint32_t at, uint32_t n,
+                           const lamp_rgb_t *color) {
+    uint32_t end = at + n < num ? at + n : num;
+    for (uint32_t i = at; i < end; i++) {
+        strip[i] = *color;
+    }
+}
+
+lamp_anim_status_t lamp_anim_next(lamp_anim_t *anim, lamp_rgb_t *strip, uint16_t num) {
+    uint8_t type, op;
+    lamp_rgb_t color;
+
+    if (anim->frame >= anim->info.frames) {
+        return LAMP_ANIM_END;
+    }
+    if (!anim_byte(anim, &type) || type > LAMP_ANIM_DELTA) {
+        return LAMP_ANIM_ERROR;
+    }
+
+    for (uint32_t at = 0; at < anim->info.leds; ) {
+        if (!anim_byte(anim, &op)) {
+            return LAMP_ANIM_ERROR;
+        }
+        uint32_t n = (op & 0x3f) + 1;
+        if (at + n > anim->info.leds) {
+            return LAMP_ANIM_ERROR;
+        }
+
+        switch (op >> 6) {
+            case LAMP_ANIM_OP_SKIP:
+                if (LAMP_ANIM_KEY == type) {
+                    return LAMP_ANIM_ERROR;
+                }
+                break;
+
+            case LAMP_ANIM_OP_PAL: {
+                uint8_t index;
+                if (!anim_byte(anim, &index) || index >= anim->info.pal_num) {
+                    return LAMP_ANIM_ERROR;
+                }
+                put_run(strip, num, at, n, &anim->pal[index]);
+                break;
+            }
+
+            case LAMP_ANIM_OP_COLOR:
+                if (!anim_bytes(anim, &color.r, 1) || !anim_bytes(anim, &color.g, 1)
+                    || !anim_bytes(anim, &color.b, 1)) {
+                    return LAMP_ANIM_ERROR;
+                }
+                put_run(strip, num, at, n, &color);
+                break;
+
+            default:
+                // raw triplets land in place, the strip is packed RGB too
+                for (uint32_t i = at; i < at + n; i++) {
+                    lamp_rgb_t *dst = i < num ? &strip[i] : &color;
+                    if (!anim_bytes(anim, (uint8_t *)dst, 3)) {
+                        return LAMP_ANIM_ERROR;
+                    }
+                }
+                break;
+        }
+        at += n;
+    }
+    anim->frame++;
+    return LAMP_ANIM_OK;
+}
@@ -0,0 +1,115 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 21:10:27
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 21:10:30
+ * @FilePath    : /shellhome-nightlamp/main/lamp_anim.h
+ * @Description : streaming decoder of compressed LED animations written by
+ *                tools/anim_encode.py, no ESP-IDF dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_ANIM_H
+#define LAMP_ANIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "lamp_frame.h"
+
+/*
+ * Stream, little endian:
+ *   header  "LANM" version:u8 pal_num:u8 (0 means 256 when flagged) leds:u16
+ *           frame_ms:u16 frames:u32 flags:u16, then pal_num RGB triplets
+ *   frame   type:u8 (0 key, 1 delta), then ops until leds pixels are covered
+ *   op      top two bits the kind, low six bits the count - 1
+ *           00 skip      keep the pixels of the previous frame, delta only
+ *           01 palette   one index, repeated
+ *           10 color     one RGB triplet, repeated
+ *           11 raw       count RGB triplets
+ */
+#define LAMP_ANIM_VERSION   1
+#define LAMP_ANIM_HDR_LEN   16
+#define LAMP_ANIM_PAL_MAX   256
+#define LAMP_ANIM_BUF       64          /**< read ahead of the source */
+
+#define LAMP_ANIM_FLAG_PAL256   (1 << 0)
+
+#define LAMP_ANIM_KEY       0
+#define LAMP_ANIM_DELTA     1
+
+#define LAMP_ANIM_OP_SKIP   0
+#define LAMP_ANIM_OP_PAL    1
+#define LAMP_ANIM_OP_COLOR  2
+#define LAMP_ANIM_OP_RAW    3
+#define LAMP_ANIM_RUN_MAX   64
+
+/**
+ * @brief Byte source, returns the bytes read, fewer only at the end
+ *
+ */
+typedef struct {
+    size_t  (*read)(void *ctx, uint8_t *buf, size_t len);
+    void                        *ctx;
+} lamp_anim_source_t;
+
+// source over a buffer in memory or mapped flash
+typedef struct {
+    const uint8_t              *data;
+    size_t                       len;
+    size_t                       pos;
+} lamp_anim_mem_t;
+
+typedef enum {
+    LAMP_ANIM_OK,                       /*!< one frame decoded */
+    LAMP_ANIM_END,                      /*!< all frames played */
+    LAMP_ANIM_ERROR,                    /*!< bad or truncated stream */
+} lamp_anim_status_t;
+
+typedef struct {
+    uint16_t                    leds;
+    uint16_t                frame_ms;
+    uint32_t                  frames;
+    uint16_t                 pal_num;
+} lamp_anim_info_t;
+
+/**
+ * @brief Decoder, the only state besides the frame it writes into
+ *
+ */
+typedef struct {
+    lamp_anim_source_t           src;
+    lamp_anim_info_t            info;
+    uint32_t                   frame;   /*!< frames decoded */
+    uint16_t                     pos;
+    uint16_t                     len;
+    uint8_t     buf[LAMP_ANIM_BUF];
+    lamp_rgb_t pal[LAMP_ANIM_PAL_MAX];
+} lamp_anim_t;
+
+// make a source reading mem
+void lamp_anim_mem_source(lamp_anim_mem_t *mem, const uint8_t *data, size_t len,
+                          lamp_anim_source_t *src);
+
+// read the header and palette
+lamp_anim_status_t lamp_anim_open(lamp_anim_t *anim, const lamp_anim_source_t *src);
+
+/**
+ * @brief Decode the next frame over the previous one in strip
+ *
+ * Pixels beyond num are decoded and dropped, pixels beyond the animation
+ * are left as they are. strip must hold the previous frame for deltas.
+ *
+ */
+lamp_anim_status_t lamp_anim_next(lamp_anim_t *anim, lamp_rgb_t *strip, uint16_t num);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_ANIM_H */
@@ -0,0 +1,75 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 19:38:44
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 19:38:47
+ * @FilePath    : /shellhome-nightlamp/main/lamp_color.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include "lamp_color.h"
+#include "lamp_color_lut.h"     /**< generated by tools/oklch_lut.py */
+
+static inline int32_t clamp_q(int32_t x) {
+    return x < 0 ? 0 : (x >= LAMP_OK_ONE ? LAMP_OK_ONE - 1 : x);
+}
+
+/**< table lookup interpolated on the low bits, the matrices amplify steps */
+#define LUT_FRAC    ((1 << LAMP_OK_LUT_SHIFT) - 1)
+#define LUT_LERP(lut, x) \
+    ((lut)[(x) >> LAMP_OK_LUT_SHIFT] + ((((int32_t)(lut)[((x) >> LAMP_OK_LUT_SHIFT) + 1] \
+      - (lut)[(x) >> LAMP_OK_LUT_SHIFT]) * ((x) & LUT_FRAC)) >> LAMP_OK_LUT_SHIFT))
+
+void lamp_oklch2lab(uint32_t h, uint32_t s, uint32_t v, lamp_oklab_t *lab) {
+    h %= 360;
+    s = s > 100 ? 100 : s;
+    v = v > 100 ? 100 : v;
+
+    // washed out colors may go brighter than saturated ones and stay in gamut
+    int32_t top = LAMP_OK_L_REF + (LAMP_OK_ONE - LAMP_OK_L_REF) * (int32_t)(100 - s) / 100;
+    int32_t chroma = LAMP_OK_C_REF * (int32_t)(s * v) / 10000;
+
+    lab->L = top * (int32_t)v / 100;
+    lab->a = (chroma * lamp_ok_hue[h][0]) >> LAMP_OK_Q;
+    lab->b = (chroma * lamp_ok_hue[h][1]) >> LAMP_OK_Q;
+}
+
+void lamp_oklab2rgb(const lamp_oklab_t *lab, lamp_rgb_t *rgb) {
+    int32_t lms[3];
+    uint8_t out[3];
+
+    for (int k = 0; k < 3; k++) {
+        int32_t x = (lamp_ok_lab2lms[k][0] * lab->L + lamp_ok_lab2lms[k][1] * lab->a
+                     + lamp_ok_lab2lms[k][2] * lab->b) >> LAMP_OK_Q;
+        x = clamp_q(x);
+        lms[k] = LUT_LERP(lamp_ok_cube, x);
+    }
+    for (int k = 0; k < 3; k++) {
+        int32_t x = (lamp_ok_lms2rgb[k][0] * lms[0] + lamp_ok_lms2rgb[k][1] * lms[1]
+                     + lamp_ok_lms2rgb[k][2] * lms[2]) >> LAMP_OK_CUBE_Q;
+        x = clamp_q(x);
+        out[k] = LUT_LERP(lamp_ok_srgb, x);
+    }
+    rgb->r = out[0];
+    rgb->g = out[1];
+    rgb->b = out[2];
+}
+
+void lamp_oklab_lerp(const lamp_oklab_t *from, const lamp_oklab_t *to,
+                     uint32_t t, lamp_oklab_t *out) {
+    out->L = from->L + (((int32_t)to->L - from->L) * (int32_t)t >> 8);
+    out->a = from->a + (((int32_t)to->a - from->a) * (int32_t)t >> 8);
+    out->b = from->b + (((int32_t)to->b - from->b) * (int32_t)t >> 8);
+}
+
+void lamp_oklch2rgb(uint32_t h, uint32_t s, uint32_t v, uint32_t *r, uint32_t *g, uint32_t *b) {
+    lamp_oklab_t lab;
+    lamp_rgb_t rgb;
+
+    lamp_oklch2lab(h, s, v, &lab);
+    lamp_oklab2rgb(&lab, &rgb);
+    *r = rgb.r;
+    *g = rgb.g;
+    *b = rgb.b;
+}
@@ -0,0 +1,56 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 19:38:20
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 19:38:23
+ * @FilePath    : /shellhome-nightlamp/main/lamp_color.h
+ * @Description : perceptual OKLab / OKLCH colors on fixed point tables, no
+ *                ESP-IDF dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_COLOR_H
+#define LAMP_COLOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+
+#include "lamp_frame.h"
+
+/**
+ * @brief OKLab color, 4.12 fixed point
+ *
+ */
+typedef struct {
+    int16_t                        L;   /*!< lightness, 4096 is white */
+    int16_t                        a;
+    int16_t                        b;
+} lamp_oklab_t;
+
+/**
+ * @brief OKLCH from the HSV style parameters of the lamp
+ *
+ * Hue in degrees keeps its HSV meaning, value sets the lightness and
+ * saturation the chroma, so equal values look equally bright on every hue
+ */
+void lamp_oklch2lab(uint32_t h, uint32_t s, uint32_t v, lamp_oklab_t *lab);
+
+// OKLab to 8 bit sRGB, out of gamut channels are clipped
+void lamp_oklab2rgb(const lamp_oklab_t *lab, lamp_rgb_t *rgb);
+
+// interpolate in OKLab, t in [0, 256]
+void lamp_oklab_lerp(const lamp_oklab_t *from, const lamp_oklab_t *to,
+                     uint32_t t, lamp_oklab_t *out);
+
+// drop in for lamp_hsv2rgb()
+void lamp_oklch2rgb(uint32_t h, uint32_t s, uint32_t v, uint32_t *r, uint32_t *g, uint32_t *b);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_COLOR_H */
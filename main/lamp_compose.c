@@ -0,0 +1,77 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-19 09:12:41
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-19 09:12:44
+ * @FilePath    : /shellhome-nightlamp/main/lamp_compose.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <string.h>
+
+#include "lamp_compose.h"
+
+void lamp_compose_init(lamp_compose_t *comp, const lamp_fx_kernels_t *kernels) {
+    memset(comp, 0, sizeof(lamp_compose_t));
+    comp->kernels = kernels;
+    for (uint8_t i = 0; i < LAMP_COMPOSE_LAYERS; i++) {
+        comp->layer[i].result = &comp->black;
+    }
+}
+
+void lamp_compose_set(lamp_compose_t *comp, uint8_t index, const lamp_frame_t *src,
+                      uint8_t mode, uint32_t alpha) {
+    if (index >= LAMP_COMPOSE_LAYERS) {
+        return;
+    }
+    lamp_layer_t *layer = &comp->layer[index];
+    alpha = alpha > LAMP_BLEND_OPAQUE ? LAMP_BLEND_OPAQUE : alpha;
+    mode = mode < LAMP_BLEND_BUTT ? mode : LAMP_BLEND_ALPHA;
+    if (src != layer->src || mode != layer->mode || alpha != layer->alpha) {
+        layer->src = src;
+        layer->mode = mode;
+        layer->alpha = alpha;
+        layer->dirty = 1;
+    }
+}
+
+void lamp_compose_touch(lamp_compose_t *comp, uint8_t index) {
+    if (index < LAMP_COMPOSE_LAYERS) {
+        comp->layer[index].dirty = 1;
+    }
+}
+
+const lamp_frame_t *lamp_compose_frame(lamp_compose_t *comp) {
+    const lamp_frame_t *below = &comp->black;
+    bool changed = false;
+
+    comp->stats.frames++;
+    for (uint8_t i = 0; i < LAMP_COMPOSE_LAYERS; i++) {
+        lamp_layer_t *layer = &comp->layer[i];
+        changed |= layer->dirty;
+        layer->dirty = 0;
+        if (!changed) {
+            // nothing changed up to here, the cached composite still holds
+            below = layer->result;
+            comp->stats.skipped += NULL != layer->src;
+            continue;
+        }
+
+        if (NULL == layer->src || 0 == layer->alpha) {
+            layer->result = below;
+        } else if (LAMP_BLEND_ALPHA == layer->mode && LAMP_BLEND_OPAQUE == layer->alpha) {
+            // covers everything below, no copy
+            layer->result = layer->src;
+            comp->stats.blended++;
+        } else {
+            memcpy(&layer->out, below, sizeof(lamp_frame_t));
+            comp->kernels->blend((uint8_t *)&layer->out, (const uint8_t *)layer->src,
+                                 sizeof(lamp_frame_t), layer->mode, layer->alpha);
+            layer->result = &layer->out;
+            comp->stats.blended++;
+        }
+        below = layer->result;
+    }
+    return below;
+}
@@ -0,0 +1,79 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-19 09:12:20
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-19 09:12:23
+ * @FilePath    : /shellhome-nightlamp/main/lamp_compose.h
+ * @Description : layer compositor over frames, no ESP-IDF dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_COMPOSE_H
+#define LAMP_COMPOSE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lamp_frame.h"
+#include "lamp_fx.h"
+
+#define LAMP_COMPOSE_LAYERS 4
+
+/**
+ * @brief One layer, its frame belongs to whoever renders it
+ *
+ * Every layer keeps the composite of itself and the layers below, so a
+ * frame only blends from the lowest changed layer up.
+ *
+ */
+typedef struct {
+    const lamp_frame_t          *src;   /*!< NULL leaves the layer out */
+    const lamp_frame_t       *result;   /*!< this layer and all below */
+    uint16_t                   alpha;   /*!< weight in [0, LAMP_BLEND_OPAQUE] */
+    uint8_t                     mode;   /*!< LAMP_BLEND_xxx */
+    uint8_t                    dirty;
+    lamp_frame_t                 out;
+} lamp_layer_t;
+
+typedef struct {
+    uint32_t                  frames;   /*!< composites asked for */
+    uint32_t                 blended;   /*!< layers blended */
+    uint32_t                 skipped;   /*!< layers taken from the cache */
+} lamp_compose_stats_t;
+
+typedef struct {
+    const lamp_fx_kernels_t *kernels;
+    lamp_layer_t    layer[LAMP_COMPOSE_LAYERS];
+    lamp_frame_t               black;   /*!< below the first layer */
+    lamp_compose_stats_t       stats;
+} lamp_compose_t;
+
+// init a compositor with every layer left out
+void lamp_compose_init(lamp_compose_t *comp, const lamp_fx_kernels_t *kernels);
+
+/**
+ * @brief Set what a layer shows and how it goes over the layers below
+ *
+ * @param src: frame of the layer, NULL leaves it out
+ * @param mode: LAMP_BLEND_xxx
+ * @param alpha: weight in [0, LAMP_BLEND_OPAQUE]
+ */
+void lamp_compose_set(lamp_compose_t *comp, uint8_t index, const lamp_frame_t *src,
+                      uint8_t mode, uint32_t alpha);
+
+// the frame of a layer changed, blend it again at the next composite
+void lamp_compose_touch(lamp_compose_t *comp, uint8_t index);
+
+// composite of all layers, blended from the lowest changed layer up
+const lamp_frame_t *lamp_compose_frame(lamp_compose_t *comp);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_COMPOSE_H */
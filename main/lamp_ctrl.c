@@ -0,0 +1,47 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 15:12:20
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 15:12:23
+ * @FilePath    : /shellhome-nightlamp/main/lamp_ctrl.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include "lamp_ctrl.h"
+
+uint32_t lamp_ctrl_apply(lamp_params_t *params, const lamp_ctrl_event_t *event) {
+    switch (event->type) {
+        case LAMP_CTRL_MODE:
+            // change mode, the renderer restarts the effect on a new epoch
+            params->lamp_mode = (params->lamp_mode + 1) % LAMP_MODE_BUTT;
+            params->epoch++;
+            params->power = 1;
+            return LAMP_CTRL_ACT_PUBLISH | LAMP_CTRL_ACT_SAVE_TIMER;
+
+        case LAMP_CTRL_COLOR:
+            if (LAMP_MODE_MARQUEE == params->lamp_mode) {
+                return LAMP_CTRL_ACT_REJECTED;
+            }
+            params->hue = event->hue;
+            params->saturation = event->saturation;
+            params->value = 100;
+            params->power = 1;
+            return LAMP_CTRL_ACT_PUBLISH | LAMP_CTRL_ACT_SAVE_TIMER;
+
+        case LAMP_CTRL_TIMER:
+            params->power = 1;
+            return LAMP_CTRL_ACT_PUBLISH | LAMP_CTRL_ACT_OFF_TIMER;
+
+        case LAMP_CTRL_OFF:
+            params->power = 0;
+            return LAMP_CTRL_ACT_PUBLISH;
+
+        case LAMP_CTRL_KICK:
+            params->kick = (params->kick + 1) & 0x7f;
+            return LAMP_CTRL_ACT_PUBLISH;
+
+        default:
+            return 0;
+    }
+}
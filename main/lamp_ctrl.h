@@ -0,0 +1,60 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 15:12:09
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 15:12:12
+ * @FilePath    : /shellhome-nightlamp/main/lamp_ctrl.h
+ * @Description : lamp control state machine, no ESP-IDF dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_CTRL_H
+#define LAMP_CTRL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+
+#include "lamp_state.h"
+
+typedef enum {
+    LAMP_CTRL_MODE,             /*!< switch to the next mode */
+    LAMP_CTRL_COLOR,            /*!< switch to the color in the event */
+    LAMP_CTRL_TIMER,            /*!< restart the off timer */
+    LAMP_CTRL_OFF,              /*!< off timer fired */
+    LAMP_CTRL_KICK,             /*!< vibration hit, feeds the particle effects */
+    LAMP_CTRL_BUTT
+} lamp_ctrl_type_t;
+
+/**
+ * @brief Event for the control state machine, random draws are made by the
+ *        caller so the state machine itself stays deterministic
+ *
+ */
+typedef struct {
+    uint8_t                     type;
+    uint8_t               saturation;
+    uint16_t                     hue;
+} lamp_ctrl_event_t;
+
+/* actions returned to the caller */
+#define LAMP_CTRL_ACT_PUBLISH       (1 << 0)    /*!< params changed */
+#define LAMP_CTRL_ACT_SAVE_TIMER    (1 << 1)    /*!< restart save timer */
+#define LAMP_CTRL_ACT_OFF_TIMER     (1 << 2)    /*!< restart off timer */
+#define LAMP_CTRL_ACT_REJECTED      (1 << 3)    /*!< not allowed in this mode */
+
+/**
+ * @brief Apply one event to the lamp parameters
+ *
+ * @return bit set of LAMP_CTRL_ACT_xxx
+ */
+uint32_t lamp_ctrl_apply(lamp_params_t *params, const lamp_ctrl_event_t *event);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_CTRL_H */
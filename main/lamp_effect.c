@@ -0,0 +1,356 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 13:06:20
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 13:06:23
+ * @FilePath    : /shellhome-nightlamp/main/lamp_effect.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lamp_effect.h"
+#include "lamp_fx.h"
+#include "lamp_layout.h"
+#include "lamp_color.h"
+#include "lamp_wave.h"
+
+/* host builds replaying an HSV capture define LAMP_HOST_HSV */
+#if defined(LAMP_HOST_BUILD) && !defined(LAMP_HOST_HSV)
+#define CONFIG_LAMP_COLOR_OKLCH 1
+#endif /* LAMP_HOST_BUILD */
+
+/* hue sweeps go through the perceptual path when enabled */
+#ifdef CONFIG_LAMP_COLOR_OKLCH
+#define sweep2rgb       lamp_oklch2rgb
+#else
+#define sweep2rgb       lamp_hsv2rgb
+#endif
+
+/* phases follow the clock so lamps sharing a timebase stay in step */
+#define MARQUEE_STEP_MS 30      /**< one degree of hue */
+#define BREATH_PERIOD_MS    4000
+#define BREATH_FRAME_MS     20
+#define BREATH_MIN      15
+#define BREATH_MAX      99
+#define NOISE_SCALE     48      /**< noise step between pixels, 8.8 */
+#define NOISE_SPEED     12      /**< noise step between frames, 8.8 */
+#define NOISE_FRAME_MS  16
+#define FIRE_COOLING    55
+#define FIRE_SPARKING   120
+
+/* particles, speeds in 16.16 pixels per frame */
+#define SPARK_BURST     16      /**< sparks per vibration hit */
+#define SPARK_AMBIENT   24      /**< chance out of 255 per frame */
+#define SPARK_GRAVITY   (-LAMP_PARTICLE_ONE / 128)
+#define COMET_CHANCE    4
+#define RAIN_CHANCE     40
+#define RAIN_GRAVITY    (-LAMP_PARTICLE_ONE / 256)
+
+typedef uint32_t (*lamp_effect_render_t)(lamp_effect_t *fx,
+                                         const lamp_params_t *params,
+                                         uint32_t now_ms, lamp_frame_t *frame);
+
+void lamp_hsv2rgb(uint32_t h, uint32_t s, uint32_t v, uint32_t *r, uint32_t *g, uint32_t *b)
+{
+    h %= 360; /**< h -> [0,360] */
+    uint32_t rgb_max = v * 2.55f;
+    uint32_t rgb_min = rgb_max * (100 - s) / 100.0f;
+
+    uint32_t i = h / 60;
+    uint32_t diff = h % 60;
+
+    /**< RGB adjustment amount by hue */
+    uint32_t rgb_adj = (rgb_max - rgb_min) * diff / 60;
+
+    switch (i) {
+        case 0:
+            *r = rgb_max;
+            *g = rgb_min + rgb_adj;
+            *b = rgb_min;
+            break;
+
+        case 1:
+            *r = rgb_max - rgb_adj;
+            *g = rgb_max;
+            *b = rgb_min;
+            break;
+
+        case 2:
+            *r = rgb_min;
+            *g = rgb_max;
+            *b = rgb_min + rgb_adj;
+            break;
+
+        case 3:
+            *r = rgb_min;
+            *g = rgb_max - rgb_adj;
+            *b = rgb_max;
+            break;
+
+        case 4:
+            *r = rgb_min + rgb_adj;
+            *g = rgb_min;
+            *b = rgb_max;
+            break;
+
+        default:
+            *r = rgb_max;
+            *g = rgb_min;
+            *b = rgb_max - rgb_adj;
+            break;
+    }
+}
+
+static uint32_t effect_marquee(lamp_effect_t *fx, const lamp_params_t *params,
+                               uint32_t now_ms, lamp_frame_t *frame) {
+    const lamp_layout_t *layout = lamp_layout();
+    uint32_t hue = now_ms / MARQUEE_STEP_MS;
+    uint32_t r, g, b;
+
+    // with coordinates the rainbow turns around the lamp, else runs along it
+    for (int i = 0; i < layout->num; i++) {
+        uint32_t offset = (layout->flags & LAMP_LAYOUT_HAS_COORDS)
+                          ? (layout->angle[i] * 45u) >> 5 : (uint32_t)i;
+        sweep2rgb(hue + offset, 100, (uint32_t)params->value, &r, &g, &b);
+        frame->strip[i].r = r;
+        frame->strip[i].g = g;
+        frame->strip[i].b = b;
+    }
+    frame->top = frame->strip[0];
+
+    return MARQUEE_STEP_MS;
+}
+
+static uint32_t effect_breath(lamp_effect_t *fx, const lamp_params_t *params,
+                              uint32_t now_ms, lamp_frame_t *frame) {
+    static const lamp_wave_t breath = LAMP_WAVE_INIT(LAMP_WAVE_EXP, BREATH_PERIOD_MS);
+    uint32_t r, g, b;
+
+    // the swing scales with the value, so a capped value dims it too
+    uint32_t value = lamp_wave_scale(lamp_wave_at(&breath, now_ms, 0),
+                                     BREATH_MIN * params->value, BREATH_MAX * params->value) / 100;
+
+    sweep2rgb((uint32_t)params->hue, 100, value, &r, &g, &b);
+    lamp_frame_fill(frame, r, g, b);
+    return BREATH_FRAME_MS;
+}
+
+static uint32_t effect_stack(lamp_effect_t *fx, const lamp_params_t *params,
+                             uint32_t now_ms, lamp_frame_t *frame) {
+    uint32_t r, g, b;
+
+    lamp_hsv2rgb((uint32_t)params->hue, (uint32_t)params->saturation,
+                 (uint32_t)params->value, &r, &g, &b);
+    lamp_frame_clear(frame);
+    lamp_rgb_t *px = 0 == fx->index ? &frame->top : &frame->strip[fx->index-1];
+    px->r = r;
+    px->g = g;
+    px->b = b;
+
+    fx->index++;
+    fx->index = fx->index > lamp_layout()->num ? 0 : fx->index;
+    return 100;
+}
+
+static uint32_t effect_fixed(lamp_effect_t *fx, const lamp_params_t *params,
+                             uint32_t now_ms, lamp_frame_t *frame) {
+    uint32_t r, g, b;
+
+    lamp_hsv2rgb((uint32_t)params->hue, (uint32_t)params->saturation,
+                 (uint32_t)params->value, &r, &g, &b);
+    lamp_frame_fill(frame, r, g, b);
+    return LAMP_EFFECT_IDLE;
+}
+
+static inline uint8_t lerp_channel(uint8_t a, uint8_t b, uint32_t t) {
+    return a + (((int32_t)b - a) * (int32_t)t >> 8);
+}
+
+static uint32_t effect_noise(lamp_effect_t *fx, const lamp_params_t *params,
+                             uint32_t now_ms, lamp_frame_t *frame) {
+    uint8_t noise[LAMP_STRIP_MAX];
+    uint16_t num = lamp_layout()->num;
+
+    // from the shared clock, lamps in sync drift the same way; the row wraps
+    // at 256 cells, so does the 16 bit position
+    uint16_t y = (uint16_t)(now_ms * NOISE_SPEED / NOISE_FRAME_MS);
+    lamp_fx_kernels()->noise_row(noise, num, 0, NOISE_SCALE, y);
+
+    // three stop palette around the lamp color: dark, color, washed out
+#ifdef CONFIG_LAMP_COLOR_OKLCH
+    lamp_oklab_t dark = {0}, base, light, mix;
+
+    lamp_oklch2lab((uint32_t)params->hue, (uint32_t)params->saturation,
+                   (uint32_t)params->value, &base);
+    lamp_oklch2lab((uint32_t)params->hue + 40, (uint32_t)params->saturation / 2,
+                   (uint32_t)params->value, &light);
+    for (int i = 0; i < num; i++) {
+        lamp_oklab_lerp(noise[i] < 128 ? &dark : &base, noise[i] < 128 ? &base : &light,
+                        (noise[i] & 0x7f) << 1, &mix);
+        lamp_oklab2rgb(&mix, &frame->strip[i]);
+    }
+#else
+    uint32_t r, g, b;
+    lamp_rgb_t dark = {0}, base, light;
+
+    lamp_hsv2rgb((uint32_t)params->hue, (uint32_t)params->saturation,
+                 (uint32_t)params->value, &r, &g, &b);
+    base = (lamp_rgb_t){r, g, b};
+    lamp_hsv2rgb((uint32_t)params->hue + 40, (uint32_t)params->saturation / 2,
+                 (uint32_t)params->value, &r, &g, &b);
+    light = (lamp_rgb_t){r, g, b};
+
+    for (int i = 0; i < num; i++) {
+        const lamp_rgb_t *from = noise[i] < 128 ? &dark : &base;
+        const lamp_rgb_t *to = noise[i] < 128 ? &base : &light;
+        uint32_t t = (noise[i] & 0x7f) << 1;
+        frame->strip[i].r = lerp_channel(from->r, to->r, t);
+        frame->strip[i].g = lerp_channel(from->g, to->g, t);
+        frame->strip[i].b = lerp_channel(from->b, to->b, t);
+    }
+#endif /* CONFIG_LAMP_COLOR_OKLCH */
+    frame->top = frame->strip[0];
+
+    return NOISE_FRAME_MS;
+}
+
+/**< dim a color of its own palette by the value, 100 leaves it */
+static inline void value_scale(lamp_rgb_t *color, uint8_t value) {
+    if (value < 100) {
+        color->r = color->r * value / 100;
+        color->g = color->g * value / 100;
+        color->b = color->b * value / 100;
+    }
+}
+
+static uint32_t effect_fire(lamp_effect_t *fx, const lamp_params_t *params,
+                            uint32_t now_ms, lamp_frame_t *frame) {
+    uint16_t num = lamp_layout()->num;
+
+    lamp_fire_step(lamp_fx_kernels(), fx->heat, num, &fx->rng,
+                   FIRE_COOLING, FIRE_SPARKING);
+    for (int i = 0; i < num; i++) {
+        lamp_heat_color(fx->heat[i], &frame->strip[i]);
+        value_scale(&frame->strip[i], params->value);
+    }
+    frame->top = frame->strip[0];
+    return 16;
+}
+
+/**< random value in [lo, hi) */
+static inline int32_t fx_range(lamp_effect_t *fx, int32_t lo, int32_t hi) {
+    return lo + (int32_t)(lamp_fx_random(&fx->rng) % (uint32_t)(hi - lo));
+}
+
+static void particle_color(lamp_effect_t *fx, const lamp_params_t *params,
+                           int32_t spread, lamp_rgb_t *color) {
+    uint32_t r, g, b;
+    uint32_t hue = (uint32_t)params->hue + 360 + fx_range(fx, -spread, spread + 1);
+
+    lamp_hsv2rgb(hue, (uint32_t)params->saturation, (uint32_t)params->value, &r, &g, &b);
+    color->r = r;
+    color->g = g;
+    color->b = b;
+}
+
+static void particle_show(lamp_effect_t *fx, lamp_frame_t *frame) {
+    lamp_particle_update(&fx->particles, lamp_layout()->num);
+    lamp_frame_clear(frame);
+    lamp_particle_render(&fx->particles, frame);
+    frame->top = frame->strip[0];
+}
+
+static uint32_t effect_sparks(lamp_effect_t *fx, const lamp_params_t *params,
+                              uint32_t now_ms, lamp_frame_t *frame) {
+    uint32_t hits = (params->kick - fx->kick) & 0x7f;
+    fx->kick = params->kick;
+
+    // every hit bursts from one point, a few sparks drift up on their own
+    for (uint32_t h = 0; h <= hits; h++) {
+        int32_t center = fx_range(fx, 0, lamp_layout()->num);
+        int32_t burst = h < hits ? SPARK_BURST : (fx_range(fx, 0, 256) < SPARK_AMBIENT);
+        for (int32_t i = 0; i < burst; i++) {
+            lamp_particle_config_t cfg = {
+                .pos  = center * LAMP_PARTICLE_ONE,
+                .vel  = fx_range(fx, -LAMP_PARTICLE_ONE / 2, LAMP_PARTICLE_ONE / 2),
+                .acc  = SPARK_GRAVITY,
+                .life = fx_range(fx, 20, 60),
+                .tail = 1,
+            };
+            lamp_heat_color(fx_range(fx, 160, 256), &cfg.color);
+            value_scale(&cfg.color, params->value);
+            lamp_particle_spawn(&fx->particles, &cfg);
+        }
+    }
+    particle_show(fx, frame);
+    return 16;
+}
+
+static uint32_t effect_comet(lamp_effect_t *fx, const lamp_params_t *params,
+                             uint32_t now_ms, lamp_frame_t *frame) {
+    if (0 == fx->particles.live || fx_range(fx, 0, 256) < COMET_CHANCE) {
+        lamp_particle_config_t cfg = {
+            .pos  = 0,
+            .vel  = fx_range(fx, LAMP_PARTICLE_ONE / 4, LAMP_PARTICLE_ONE),
+            .tail = fx_range(fx, 4, 11),
+        };
+        // live just long enough to leave the strip, fading on the way
+        uint32_t life = ((lamp_layout()->num + cfg.tail + 2) * LAMP_PARTICLE_ONE) / cfg.vel + 1;
+        cfg.life = life > UINT16_MAX ? UINT16_MAX : life;
+        particle_color(fx, params, 30, &cfg.color);
+        lamp_particle_spawn(&fx->particles, &cfg);
+    }
+    particle_show(fx, frame);
+    return 16;
+}
+
+static uint32_t effect_rain(lamp_effect_t *fx, const lamp_params_t *params,
+                            uint32_t now_ms, lamp_frame_t *frame) {
+    if (fx_range(fx, 0, 256) < RAIN_CHANCE) {
+        lamp_particle_config_t cfg = {
+            .pos  = (lamp_layout()->num - 1) * LAMP_PARTICLE_ONE,
+            .vel  = -fx_range(fx, LAMP_PARTICLE_ONE / 20, LAMP_PARTICLE_ONE / 5),
+            .acc  = RAIN_GRAVITY,
+            .life = 255,
+            .tail = 2,
+        };
+        particle_color(fx, params, 15, &cfg.color);
+        lamp_particle_spawn(&fx->particles, &cfg);
+    }
+    particle_show(fx, frame);
+    return 16;
+}
+
+static const lamp_effect_render_t g_effects[LAMP_MODE_BUTT] = {
+    [LAMP_MODE_MARQUEE] = effect_marquee,
+    [LAMP_MODE_BREATH]  = effect_breath,
+    [LAMP_MODE_STACK]   = effect_stack,
+    [LAMP_MODE_FIXED]   = effect_fixed,
+    [LAMP_MODE_NOISE]   = effect_noise,
+    [LAMP_MODE_FIRE]    = effect_fire,
+    [LAMP_MODE_SPARKS]  = effect_sparks,
+    [LAMP_MODE_COMET]   = effect_comet,
+    [LAMP_MODE_RAIN]    = effect_rain,
+};
+
+void lamp_effect_start(lamp_effect_t *fx, const lamp_params_t *params) {
+    memset(fx, 0, sizeof(lamp_effect_t));
+    fx->lamp_mode = params->lamp_mode;
+    // the low byte only, all a capture keeps, so replay seeds the same
+    fx->rng = 0x9e3779b9u ^ (params->epoch & 0xff);
+    fx->rng = fx->rng ? fx->rng : 1;
+    fx->kick = params->kick;
+    lamp_particle_init(&fx->particles);
+}
+
+uint32_t lamp_effect_render(lamp_effect_t *fx, const lamp_params_t *params,
+                            uint32_t now_ms, lamp_frame_t *frame) {
+    if (fx->lamp_mode >= LAMP_MODE_BUTT) {
+        lamp_frame_clear(frame);
+        return LAMP_EFFECT_IDLE;
+    }
+    return g_effects[fx->lamp_mode](fx, params, now_ms, frame);
+}
@@ -0,0 +1,72 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 13:06:02
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 13:06:05
+ * @FilePath    : /shellhome-nightlamp/main/lamp_effect.h
+ * @Description : lamp effects rendering into a frame, no ESP-IDF dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_EFFECT_H
+#define LAMP_EFFECT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+
+#include "lamp_state.h"
+#include "lamp_frame.h"
+#include "lamp_particle.h"
+
+// interval of a frame that only changes with the parameters
+#define LAMP_EFFECT_IDLE    UINT32_MAX
+
+/**
+ * @brief Animation state of one effect instance
+ *
+ */
+typedef struct {
+    uint8_t                lamp_mode;
+    uint32_t                   index;
+    uint32_t                     rng;   /*!< seeded from the low byte of the epoch */
+    uint8_t                     kick;   /*!< last kick count consumed */
+    union {
+        uint8_t heat[LAMP_STRIP_MAX];   /*!< fire heat map */
+        lamp_particle_pool_t particles; /*!< sparks, comet and rain */
+    };
+} lamp_effect_t;
+
+/**
+ * @brief Simple helper function, converting HSV color space to RGB color space
+ *
+ * Wiki: https://en.wikipedia.org/wiki/HSL_and_HSV
+ *
+ */
+void lamp_hsv2rgb(uint32_t h, uint32_t s, uint32_t v, uint32_t *r, uint32_t *g, uint32_t *b);
+
+// start an effect for the mode in params
+void lamp_effect_start(lamp_effect_t *fx, const lamp_params_t *params);
+
+/**
+ * @brief Render the next frame of an effect
+ *
+ * @param fx: effect state, advanced by one step
+ * @param params: current lamp parameters
+ * @param now_ms: time of the frame, shared between synchronized lamps
+ * @param frame: frame to render into
+ *
+ * @return interval in ms until the next frame is due, LAMP_EFFECT_IDLE for
+ *         a static frame or an unknown mode
+ */
+uint32_t lamp_effect_render(lamp_effect_t *fx, const lamp_params_t *params,
+                            uint32_t now_ms, lamp_frame_t *frame);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_EFFECT_H */
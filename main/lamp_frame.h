@@ -0,0 +1,64 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 13:05:12
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 13:05:15
+ * @FilePath    : /shellhome-nightlamp/main/lamp_frame.h
+ * @Description :
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_FRAME_H
+#define LAMP_FRAME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef LAMP_HOST_BUILD
+#ifndef CONFIG_STRIP_LED_NUM
+#define CONFIG_STRIP_LED_NUM    47
+#endif
+#else
+#include "sdkconfig.h"
+#endif /* LAMP_HOST_BUILD */
+
+#define LAMP_STRIP_MAX      CONFIG_STRIP_LED_NUM
+
+typedef struct {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+} lamp_rgb_t;
+
+/**
+ * @brief One frame of the lamp, the top LED and every strip pixel
+ *
+ */
+typedef struct {
+    lamp_rgb_t                   top;
+    lamp_rgb_t strip[LAMP_STRIP_MAX];
+} lamp_frame_t;
+
+static inline void lamp_frame_fill(lamp_frame_t *frame, uint8_t r, uint8_t g, uint8_t b) {
+    frame->top.r = r;
+    frame->top.g = g;
+    frame->top.b = b;
+    for (int i = 0; i < LAMP_STRIP_MAX; i++) {
+        frame->strip[i] = frame->top;
+    }
+}
+
+static inline void lamp_frame_clear(lamp_frame_t *frame) {
+    memset(frame, 0, sizeof(lamp_frame_t));
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_FRAME_H */
@@ -0,0 +1,382 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 16:02:30
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 16:02:33
+ * @FilePath    : /shellhome-nightlamp/main/lamp_fx.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lamp_fx.h"
+
+/**
+ * @brief Ken Perlin's permutation table
+ *
+ */
+static const uint8_t NoisePerm[256] = {
+    151, 160, 137,  91,  90,  15, 131,  13, 201,  95,  96,  53, 194, 233,   7, 225,
+    140,  36, 103,  30,  69, 142,   8,  99,  37, 240,  21,  10,  23, 190,   6, 148,
+    247, 120, 234,  75,   0,  26, 197,  62,  94, 252, 219, 203, 117,  35,  11,  32,
+     57, 177,  33,  88, 237, 149,  56,  87, 174,  20, 125, 136, 171, 168,  68, 175,
+     74, 165,  71, 134, 139,  48,  27, 166,  77, 146, 158, 231,  83, 111, 229, 122,
+     60, 211, 133, 230, 220, 105,  92,  41,  55,  46, 245,  40, 244, 102, 143,  54,
+     65,  25,  63, 161,   1, 216,  80,  73, 209,  76, 132, 187, 208,  89,  18, 169,
+    200, 196, 135, 130, 116, 188, 159,  86, 164, 100, 109, 198, 173, 186,   3,  64,
+     52, 217, 226, 250, 124, 123,   5, 202,  38, 147, 118, 126, 255,  82,  85, 212,
+    207, 206,  59, 227,  47,  16,  58,  17, 182, 189,  28,  42, 223, 183, 170, 213,
+    119, 248, 152,   2,  44, 154, 163,  70, 221, 153, 101, 155, 167,  43, 172,   9,
+    129,  22,  39, 253,  19,  98, 108, 110,  79, 113, 224, 232, 178, 185, 112, 104,
+    218, 246,  97, 228, 251,  34, 242, 193, 238, 210, 144,  12, 191, 179, 162, 241,
+     81,  51, 145, 235, 249,  14, 239, 107,  49, 192, 214,  31, 181, 199, 106, 157,
+    184,  84, 204, 176, 115, 121,  50,  45, 127,   4, 150, 254, 138, 236, 205,  93,
+    222, 114,  67,  29,  24,  72, 243, 141, 128, 195,  78,  66, 215,  61, 156, 180
+};
+
+#define P(x)    NoisePerm[(uint8_t)(x)]
+
+/* packed byte helpers, four pixels per word */
+#define LANE_EVEN   0x00ff00ffu
+#define LANE_LSB    0xfefefefeu
+
+uint32_t lamp_fx_random(uint32_t *rng) {
+    uint32_t x = *rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *rng = x;
+    return x;
+}
+
+/**< smoothstep 3t^2 - 2t^3 on a Q8 fraction */
+static inline int32_t ease8(int32_t t) {
+    return (t * t * (768 - 2 * t)) >> 16;
+}
+
+static inline int32_t lerp8(int32_t a, int32_t b, int32_t t) {
+    return a + (((b - a) * t) >> 8);
+}
+
+/**< dot product of one of 8 gradients with the Q8 offset (x, y) */
+static inline int32_t grad2(uint8_t hash, int32_t x, int32_t y) {
+    switch (hash & 7) {
+        case 0:  return  x + y;
+        case 1:  return -x + y;
+        case 2:  return  x - y;
+        case 3:  return -x - y;
+        case 4:  return  x;
+        case 5:  return -x;
+        case 6:  return  y;
+        default: return -y;
+    }
+}
+
+static inline uint8_t noise_out(int32_t n) {
+    n = 128 + (n >> 1);
+    return n < 0 ? 0 : (n > 255 ? 255 : n);
+}
+
+uint8_t lamp_noise8(uint16_t x, uint16_t y) {
+    uint8_t X = x >> 8, Y = y >> 8;
+    int32_t fx = x & 0xff, fy = y & 0xff;
+    int32_t u = ease8(fx), v = ease8(fy);
+
+    uint8_t a = P(X) + Y, b = P(X + 1) + Y;
+    int32_t n0 = lerp8(grad2(P(a),     fx, fy),       grad2(P(b),     fx - 256, fy),       u);
+    int32_t n1 = lerp8(grad2(P(a + 1), fx, fy - 256), grad2(P(b + 1), fx - 256, fy - 256), u);
+    return noise_out(lerp8(n0, n1, v));
+}
+
+static void noise_row_ref(uint8_t *out, size_t num, uint16_t x, uint16_t dx, uint16_t y) {
+    for (size_t i = 0; i < num; i++, x += dx) {
+        out[i] = lamp_noise8(x, y);
+    }
+}
+
+static void noise_row_fast(uint8_t *out, size_t num, uint16_t x, uint16_t dx, uint16_t y) {
+    uint8_t Y = y >> 8;
+    int32_t fy = y & 0xff, fy1 = fy - 256;
+    int32_t v = ease8(fy);
+    uint16_t cell = (x >> 8) + 1;   /**< force the first lookup */
+    uint8_t h00 = 0, h10 = 0, h01 = 0, h11 = 0;
+
+    // the row is fixed in y, hash the four corners only when x enters a new cell
+    for (size_t i = 0; i < num; i++, x += dx) {
+        uint8_t X = x >> 8;
+        if (X != cell) {
+            uint8_t a = P(X) + Y, b = P(X + 1) + Y;
+            h00 = P(a);
+            h10 = P(b);
+            h01 = P(a + 1);
+            h11 = P(b + 1);
+            cell = X;
+        }
+        int32_t fx = x & 0xff, fx1 = fx - 256;
+        int32_t u = ease8(fx);
+        int32_t n0 = lerp8(grad2(h00, fx, fy),  grad2(h10, fx1, fy),  u);
+        int32_t n1 = lerp8(grad2(h01, fx, fy1), grad2(h11, fx1, fy1), u);
+        out[i] = noise_out(lerp8(n0, n1, v));
+    }
+}
+
+static inline uint8_t cool_amount(uint32_t word, uint32_t lane, uint8_t limit) {
+    return (((word >> (lane * 8)) & 0xff) * limit) >> 8;
+}
+
+static void fire_cool_ref(uint8_t *heat, size_t num, uint32_t *rng, uint8_t limit) {
+    for (size_t i = 0; i < num; i += 4) {
+        uint32_t word = lamp_fx_random(rng);
+        for (size_t j = 0; j < 4 && i + j < num; j++) {
+            uint8_t cool = cool_amount(word, j, limit);
+            heat[i + j] = heat[i + j] > cool ? heat[i + j] - cool : 0;
+        }
+    }
+}
+
+/**< per byte (a * limit) >> 8, two bytes per multiply */
+static inline uint32_t scale_packed(uint32_t a, uint8_t limit) {
+    uint32_t even = (((a & LANE_EVEN) * limit) >> 8) & LANE_EVEN;
+    uint32_t odd = (((a >> 8) & LANE_EVEN) * limit) & ~LANE_EVEN;
+    return even | odd;
+}
+
+/**< per byte saturating a - b */
+static inline uint32_t sub_sat_packed(uint32_t a, uint32_t b) {
+    // borrow into bit 8 of each 16 bit lane tells whether a >= b
+    uint32_t even = ((a & LANE_EVEN) | 0x01000100u) - (b & LANE_EVEN);
+    uint32_t odd = (((a >> 8) & LANE_EVEN) | 0x01000100u) - ((b >> 8) & LANE_EVEN);
+    even &= ((even >> 8) & 0x00010001u) * 0xff;
+    odd &= ((odd >> 8) & 0x00010001u) * 0xff;
+    return (even & LANE_EVEN) | ((odd & LANE_EVEN) << 8);
+}
+
+/**< per byte floor((a + b) / 2) */
+static inline uint32_t avg_packed(uint32_t a, uint32_t b) {
+    return (a & b) + (((a ^ b) & LANE_LSB) >> 1);
+}
+
+static inline uint32_t load_packed(const uint8_t *p) {
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+static inline void store_packed(uint8_t *p, uint32_t w) {
+    memcpy(p, &w, sizeof(w));
+}
+
+// lanes map to memory order, both targets are little endian
+static void fire_cool_fast(uint8_t *heat, size_t num, uint32_t *rng, uint8_t limit) {
+    size_t i = 0;
+    for (; i + 4 <= num; i += 4) {
+        uint32_t cool = scale_packed(lamp_fx_random(rng), limit);
+        store_packed(&heat[i], sub_sat_packed(load_packed(&heat[i]), cool));
+    }
+    if (i < num) {
+        fire_cool_ref(&heat[i], num - i, rng, limit);
+    }
+}
+
+static inline uint8_t avg8(uint8_t a, uint8_t b) {
+    return (a + b) >> 1;
+}
+
+static void fire_diffuse_ref(uint8_t *heat, size_t num) {
+    // top down, every cell reads only cells not yet updated
+    for (size_t k = num - 1; k >= 3 && k < num; k--) {
+        heat[k] = avg8(avg8(heat[k - 1], heat[k - 3]), heat[k - 2]);
+    }
+}
+
+static void fire_diffuse_fast(uint8_t *heat, size_t num) {
+    size_t k = num;
+    // blocks of four, the lowest block must still have three cells below it
+    for (; k >= 7; k -= 4) {
+        size_t s = k - 4;
+        uint32_t w = avg_packed(avg_packed(load_packed(&heat[s - 1]),
+                                           load_packed(&heat[s - 3])),
+                                load_packed(&heat[s - 2]));
+        store_packed(&heat[s], w);
+    }
+    if (k > 3) {
+        fire_diffuse_ref(heat, k);
+    }
+}
+
+/**< offset of r, g and b in a packed pixel, looked up as a generic driver does */
+static const uint8_t PackOrder[3] = {LAMP_PACK_R, LAMP_PACK_G, LAMP_PACK_B};
+
+static inline void set_pixel_ref(uint8_t *out, size_t max, size_t index,
+                                 const lamp_rgb_t *rgb) {
+    if (index >= max) {
+        return;
+    }
+    uint8_t *p = out + index * LAMP_PACK_BYTES;
+    p[PackOrder[0]] = rgb->r;
+    p[PackOrder[1]] = rgb->g;
+    p[PackOrder[2]] = rgb->b;
+}
+
+static void pack_grb_ref(uint8_t *out, size_t max, const lamp_rgb_t *rgb,
+                         const uint16_t *phys, size_t num) {
+    for (size_t i = 0; i < num; i++) {
+        set_pixel_ref(out, max, NULL == phys ? i : phys[i], &rgb[i]);
+    }
+}
+
+#define PACK_ONE(o, s)                  \
+    do {                                \
+        (o)[LAMP_PACK_G] = (s)->g;      \
+        (o)[LAMP_PACK_R] = (s)->r;      \
+        (o)[LAMP_PACK_B] = (s)->b;      \
+    } while (0)
+
+static void pack_grb_fast(uint8_t *out, size_t max, const lamp_rgb_t *rgb,
+                          const uint16_t *phys, size_t num) {
+    size_t i = 0;
+
+    // format fixed at build time, four pixels per iteration and no checks,
+    // the layout already keeps phys below max
+    if (NULL == phys) {
+        for (; i + 4 <= num; i += 4, out += 4 * LAMP_PACK_BYTES) {
+            PACK_ONE(out, &rgb[i]);
+            PACK_ONE(out + 3, &rgb[i + 1]);
+            PACK_ONE(out + 6, &rgb[i + 2]);
+            PACK_ONE(out + 9, &rgb[i + 3]);
+        }
+        for (; i < num; i++, out += LAMP_PACK_BYTES) {
+            PACK_ONE(out, &rgb[i]);
+        }
+        return;
+    }
+    for (; i + 4 <= num; i += 4) {
+        PACK_ONE(out + phys[i] * LAMP_PACK_BYTES, &rgb[i]);
+        PACK_ONE(out + phys[i + 1] * LAMP_PACK_BYTES, &rgb[i + 1]);
+        PACK_ONE(out + phys[i + 2] * LAMP_PACK_BYTES, &rgb[i + 2]);
+        PACK_ONE(out + phys[i + 3] * LAMP_PACK_BYTES, &rgb[i + 3]);
+    }
+    for (; i < num; i++) {
+        PACK_ONE(out + phys[i] * LAMP_PACK_BYTES, &rgb[i]);
+    }
+}
+
+static void blend_ref(uint8_t *dst, const uint8_t *src, size_t num, uint8_t mode, uint32_t alpha) {
+    const uint32_t inv = LAMP_BLEND_OPAQUE - alpha;
+
+    for (size_t i = 0; i < num; i++) {
+        uint32_t s = (src[i] * alpha) >> 8;
+        switch (mode) {
+            case LAMP_BLEND_ADD:
+                s += dst[i];
+                dst[i] = s > 255 ? 255 : s;
+                break;
+
+            case LAMP_BLEND_MAX:
+                dst[i] = s > dst[i] ? s : dst[i];
+                break;
+
+            default:
+                dst[i] = (dst[i] * inv + src[i] * alpha) >> 8;
+                break;
+        }
+    }
+}
+
+/**< per byte saturating a + b */
+static inline uint32_t add_sat_packed(uint32_t a, uint32_t b) {
+    // a carry into bit 8 of a 16 bit lane saturates that byte
+    uint32_t even = (a & LANE_EVEN) + (b & LANE_EVEN);
+    uint32_t odd = ((a >> 8) & LANE_EVEN) + ((b >> 8) & LANE_EVEN);
+    even |= ((even >> 8) & 0x00010001u) * 0xff;
+    odd |= ((odd >> 8) & 0x00010001u) * 0xff;
+    return (even & LANE_EVEN) | ((odd & LANE_EVEN) << 8);
+}
+
+static void blend_fast(uint8_t *dst, const uint8_t *src, size_t num, uint8_t mode, uint32_t alpha) {
+    const uint32_t inv = LAMP_BLEND_OPAQUE - alpha;
+    size_t i = 0;
+
+    for (; i + 4 <= num; i += 4) {
+        uint32_t d = load_packed(&dst[i]);
+        uint32_t s = load_packed(&src[i]);
+        if (LAMP_BLEND_ALPHA == mode) {
+            // two lanes per multiply, the weights sum to 256 so no lane overflows
+            uint32_t even = (d & LANE_EVEN) * inv + (s & LANE_EVEN) * alpha;
+            uint32_t odd = ((d >> 8) & LANE_EVEN) * inv + ((s >> 8) & LANE_EVEN) * alpha;
+            store_packed(&dst[i], ((even >> 8) & LANE_EVEN) | (odd & ~LANE_EVEN));
+            continue;
+        }
+        s = alpha < LAMP_BLEND_OPAQUE ? scale_packed(s, alpha) : s;
+        // max(d, s) is s plus what d has above it
+        store_packed(&dst[i], LAMP_BLEND_ADD == mode ? add_sat_packed(d, s)
+                                                     : s + sub_sat_packed(d, s));
+    }
+    if (i < num) {
+        blend_ref(&dst[i], &src[i], num - i, mode, alpha);
+    }
+}
+
+const lamp_fx_kernels_t lamp_fx_ref = {
+    .name         = "ref",
+    .noise_row    = noise_row_ref,
+    .fire_cool    = fire_cool_ref,
+    .fire_diffuse = fire_diffuse_ref,
+    .pack_grb     = pack_grb_ref,
+    .blend        = blend_ref,
+};
+
+const lamp_fx_kernels_t lamp_fx_fast = {
+    .name         = "fast",
+    .noise_row    = noise_row_fast,
+    .fire_cool    = fire_cool_fast,
+    .fire_diffuse = fire_diffuse_fast,
+    .pack_grb     = pack_grb_fast,
+    .blend        = blend_fast,
+};
+
+const lamp_fx_kernels_t *lamp_fx_kernels(void) {
+#ifdef CONFIG_LAMP_FX_FAST
+    return &lamp_fx_fast;
+#else
+    return &lamp_fx_ref;
+#endif
+}
+
+void lamp_fire_step(const lamp_fx_kernels_t *kernels, uint8_t *heat, size_t num,
+                    uint32_t *rng, uint8_t cooling, uint8_t sparking) {
+    if (num < 4) {
+        return;
+    }
+    kernels->fire_cool(heat, num, rng, (cooling * 10) / num + 2);
+    kernels->fire_diffuse(heat, num);
+
+    // light a new spark near the bottom
+    uint32_t r = lamp_fx_random(rng);
+    if ((r & 0xff) < sparking) {
+        uint8_t y = (((r >> 8) & 0xff) * 7) >> 8;
+        uint32_t h = heat[y] + 160 + ((((r >> 16) & 0xff) * 95) >> 8);
+        heat[y] = h > 255 ? 255 : h;
+    }
+}
+
+void lamp_heat_color(uint8_t heat, lamp_rgb_t *rgb) {
+    uint8_t t192 = (heat * 191) >> 8;
+    uint8_t ramp = (t192 & 0x3f) << 2;
+
+    if (t192 & 0x80) {
+        rgb->r = 255;
+        rgb->g = 255;
+        rgb->b = ramp;
+    } else if (t192 & 0x40) {
+        rgb->r = 255;
+        rgb->g = ramp;
+        rgb->b = 0;
+    } else {
+        rgb->r = ramp;
+        rgb->g = 0;
+        rgb->b = 0;
+    }
+}
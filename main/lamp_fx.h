@@ -0,0 +1,119 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 16:02:11
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 16:02:14
+ * @FilePath    : /shellhome-nightlamp/main/lamp_fx.h
+ * @Description : fixed-point kernels for the procedural effects, no ESP-IDF
+ *                dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_FX_H
+#define LAMP_FX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "lamp_frame.h"
+
+/* host builds replaying a capture with the reference kernels define LAMP_HOST_REF */
+#if defined(LAMP_HOST_BUILD) && !defined(LAMP_HOST_REF)
+#define CONFIG_LAMP_FX_FAST     1
+#endif /* LAMP_HOST_BUILD */
+
+/* strip pixel format, WS2812 takes green first */
+#define LAMP_PACK_BYTES     3
+#define LAMP_PACK_G         0
+#define LAMP_PACK_R         1
+#define LAMP_PACK_B         2
+
+/* how a layer goes over the layers below it */
+#define LAMP_BLEND_ALPHA    0           /**< dst + (src - dst) * alpha */
+#define LAMP_BLEND_ADD      1           /**< dst + src * alpha, saturating */
+#define LAMP_BLEND_MAX      2           /**< the brighter of dst and src * alpha */
+#define LAMP_BLEND_BUTT     3
+#define LAMP_BLEND_OPAQUE   256         /**< alpha of a layer at full weight */
+
+/**
+ * @brief One set of kernels, the reference set works a pixel at a time and
+ *        the fast set packs four pixels into a word; both give identical
+ *        output
+ *
+ */
+typedef struct {
+    const char                 *name;
+
+    /**
+    * @brief Render one row of 2D noise
+    *
+    * @param out: noise values 0..255
+    * @param x: position of the first pixel, 8.8 fixed point
+    * @param dx: step between pixels, 8.8 fixed point
+    * @param y: position of the row, 8.8 fixed point
+    */
+    void (*noise_row)(uint8_t *out, size_t num, uint16_t x, uint16_t dx, uint16_t y);
+
+    /**
+    * @brief Cool every cell of a heat map by a random amount below limit
+    */
+    void (*fire_cool)(uint8_t *heat, size_t num, uint32_t *rng, uint8_t limit);
+
+    /**
+    * @brief Let heat drift up, each cell from 3 and above becomes a weighted
+    *        average of the three cells below it
+    */
+    void (*fire_diffuse)(uint8_t *heat, size_t num);
+
+    /**
+    * @brief Pack num pixels into the wire format of the strip
+    *
+    * @param out: LAMP_PACK_BYTES per physical LED, room for max LEDs
+    * @param phys: physical LED of every pixel below max, NULL when in order
+    */
+    void (*pack_grb)(uint8_t *out, size_t max, const lamp_rgb_t *rgb,
+                     const uint16_t *phys, size_t num);
+
+    /**
+    * @brief Blend num channel bytes of src onto dst in place
+    *
+    * @param mode: LAMP_BLEND_xxx
+    * @param alpha: weight of src in [0, LAMP_BLEND_OPAQUE]
+    */
+    void (*blend)(uint8_t *dst, const uint8_t *src, size_t num, uint8_t mode, uint32_t alpha);
+} lamp_fx_kernels_t;
+
+extern const lamp_fx_kernels_t lamp_fx_ref;
+extern const lamp_fx_kernels_t lamp_fx_fast;
+
+// kernels selected by CONFIG_LAMP_FX_FAST
+const lamp_fx_kernels_t *lamp_fx_kernels(void);
+
+// xorshift32, deterministic so captures replay exactly
+uint32_t lamp_fx_random(uint32_t *rng);
+
+// 2D gradient noise, x and y in 8.8 fixed point, result 0..255
+uint8_t lamp_noise8(uint16_t x, uint16_t y);
+
+/**
+ * @brief Advance a Fire2012 style heat map by one step
+ *
+ * @param cooling: how fast cells cool down, 20..100
+ * @param sparking: chance out of 255 to light a new spark at the bottom
+ */
+void lamp_fire_step(const lamp_fx_kernels_t *kernels, uint8_t *heat, size_t num,
+                    uint32_t *rng, uint8_t cooling, uint8_t sparking);
+
+// map heat to black, red, yellow and white
+void lamp_heat_color(uint8_t heat, lamp_rgb_t *rgb);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_FX_H */
@@ -0,0 +1,115 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 11:20:40
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 11:20:43
+ * @FilePath    : /shellhome-nightlamp/main/lamp_gesture.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <string.h>
+
+#include "lamp_gesture.h"
+
+void lamp_gesture_init(lamp_gesture_rec_t *rec, const lamp_gesture_config_t *cfg) {
+    memset(rec, 0, sizeof(lamp_gesture_rec_t));
+    rec->cfg = *cfg;
+}
+
+lamp_gesture_t lamp_gesture_feed(lamp_gesture_rec_t *rec, uint32_t now_ms) {
+    // a hit after the quiet time belongs to a new sequence, even if the
+    // caller never polled in between
+    lamp_gesture_t closed = lamp_gesture_poll(rec, now_ms);
+
+    if (!rec->pending) {
+        // first hit of a new sequence
+        rec->pending = 1;
+        rec->first_ms = now_ms;
+        rec->last_ms = now_ms;
+        rec->hits = 1;
+        return closed;
+    }
+
+    if (now_ms - rec->last_ms < rec->cfg.debounce_ms) {
+        // bounce of the same hit
+        return LAMP_GESTURE_NONE;
+    }
+
+    rec->last_ms = now_ms;
+    if (rec->shaking) {
+        // already reported, wait for the lamp to calm down
+        return LAMP_GESTURE_NONE;
+    }
+
+    rec->hits++;
+    if (rec->hits >= rec->cfg.shake_hits &&
+        now_ms - rec->first_ms <= rec->cfg.shake_ms) {
+        rec->shaking = 1;
+        return LAMP_GESTURE_SHAKE;
+    }
+    return LAMP_GESTURE_NONE;
+}
+
+lamp_gesture_t lamp_gesture_poll(lamp_gesture_rec_t *rec, uint32_t now_ms) {
+    if (!rec->pending || now_ms - rec->last_ms < rec->cfg.double_ms) {
+        return LAMP_GESTURE_NONE;
+    }
+
+    // sequence closed by quiet time
+    rec->pending = 0;
+    if (rec->shaking) {
+        rec->shaking = 0;
+        return LAMP_GESTURE_NONE;
+    }
+
+    if (1 == rec->hits) {
+        return LAMP_GESTURE_TAP;
+    } else if (2 == rec->hits) {
+        return LAMP_GESTURE_DOUBLE_TAP;
+    }
+    return LAMP_GESTURE_KNOCK;
+}
+
+uint32_t lamp_gesture_timeout(const lamp_gesture_rec_t *rec, uint32_t now_ms) {
+    if (!rec->pending) {
+        return UINT32_MAX;
+    }
+
+    uint32_t quiet = now_ms - rec->last_ms;
+    return quiet >= rec->cfg.double_ms ? 0 : rec->cfg.double_ms - quiet;
+}
+
+void lamp_gesture_replay(const lamp_gesture_config_t *cfg,
+                         const uint32_t *edges_ms, size_t num,
+                         lamp_gesture_cb_t cb, void *arg) {
+    lamp_gesture_rec_t rec;
+    lamp_gesture_t gesture;
+
+    lamp_gesture_init(&rec, cfg);
+    for (size_t i = 0; i < num; i++) {
+        // close sequences that timed out before this edge
+        uint32_t timeout = lamp_gesture_timeout(&rec, edges_ms[i]);
+        if (0 == timeout) {
+            uint32_t at_ms = rec.last_ms + rec.cfg.double_ms;
+            gesture = lamp_gesture_poll(&rec, edges_ms[i]);
+            if (LAMP_GESTURE_NONE != gesture) cb(gesture, at_ms, arg);
+        }
+
+        gesture = lamp_gesture_feed(&rec, edges_ms[i]);
+        if (LAMP_GESTURE_NONE != gesture) cb(gesture, edges_ms[i], arg);
+    }
+
+    if (rec.pending) {
+        uint32_t at_ms = rec.last_ms + rec.cfg.double_ms;
+        gesture = lamp_gesture_poll(&rec, at_ms);
+        if (LAMP_GESTURE_NONE != gesture) cb(gesture, at_ms, arg);
+    }
+}
+
+const char *lamp_gesture_name(lamp_gesture_t gesture) {
+    static const char *names[LAMP_GESTURE_BUTT] = {
+        "none", "tap", "double-tap", "knock", "shake"
+    };
+    return gesture < LAMP_GESTURE_BUTT ? names[gesture] : "unknown";
+}
@@ -0,0 +1,79 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 11:20:31
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 11:20:34
+ * @FilePath    : /shellhome-nightlamp/main/lamp_gesture.h
+ * @Description : vibration gesture recognizer, no ESP-IDF dependency so it
+ *                also builds on the host
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_GESTURE_H
+#define LAMP_GESTURE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    LAMP_GESTURE_NONE,
+    LAMP_GESTURE_TAP,
+    LAMP_GESTURE_DOUBLE_TAP,
+    LAMP_GESTURE_KNOCK,         /*!< three or more separate hits */
+    LAMP_GESTURE_SHAKE,         /*!< many hits in a short window */
+    LAMP_GESTURE_BUTT
+} lamp_gesture_t;
+
+/**
+* @brief Gesture recognizer Configuration Type
+*
+*/
+typedef struct {
+    uint32_t    debounce_ms;    /*!< edges closer than this are one hit */
+    uint32_t      double_ms;    /*!< quiet time that closes a sequence */
+    uint32_t       shake_ms;    /*!< window a shake has to fit in */
+    uint32_t     shake_hits;    /*!< hits within shake_ms making a shake */
+} lamp_gesture_config_t;
+
+typedef struct {
+    lamp_gesture_config_t cfg;
+    uint32_t         first_ms;
+    uint32_t          last_ms;
+    uint32_t             hits;
+    uint8_t           pending;
+    uint8_t           shaking;
+} lamp_gesture_rec_t;
+
+typedef void (*lamp_gesture_cb_t)(lamp_gesture_t gesture, uint32_t at_ms, void *arg);
+
+// init recognizer
+void lamp_gesture_init(lamp_gesture_rec_t *rec, const lamp_gesture_config_t *cfg);
+
+// feed a falling edge, returns a gesture when it is recognised at once or
+// when the edge closes a sequence whose quiet time has passed
+lamp_gesture_t lamp_gesture_feed(lamp_gesture_rec_t *rec, uint32_t now_ms);
+
+// close a sequence after its quiet time, returns the gesture if any
+lamp_gesture_t lamp_gesture_poll(lamp_gesture_rec_t *rec, uint32_t now_ms);
+
+// ms until lamp_gesture_poll() has to be called, UINT32_MAX when idle
+uint32_t lamp_gesture_timeout(const lamp_gesture_rec_t *rec, uint32_t now_ms);
+
+// run a recorded trace of edge timestamps through a fresh recognizer
+void lamp_gesture_replay(const lamp_gesture_config_t *cfg,
+                         const uint32_t *edges_ms, size_t num,
+                         lamp_gesture_cb_t cb, void *arg);
+
+// gesture name for logs
+const char *lamp_gesture_name(lamp_gesture_t gesture);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_GESTURE_H */
@@ -0,0 +1,133 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 23:02:36
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 23:02:39
+ * @FilePath    : /shellhome-nightlamp/main/lamp_latency.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <string.h>
+
+#include "lamp_latency.h"
+
+enum {
+    PROBE_EMPTY,
+    PROBE_FILLING,                      /*!< an input is writing the slot */
+    PROBE_ARMED,
+    PROBE_APPLIED,
+};
+
+static const char *g_source_names[LAMP_LATENCY_SOURCE_NUM] = {
+    [LAMP_LATENCY_BUTTON_1] = "button1",
+    [LAMP_LATENCY_BUTTON_2] = "button2",
+    [LAMP_LATENCY_GESTURE]  = "gesture",
+    [LAMP_LATENCY_KICK]     = "kick",
+};
+
+void lamp_latency_init(lamp_latency_t *lat) {
+    memset(lat, 0, sizeof(lamp_latency_t));
+    for (uint32_t i = 0; i < LAMP_LATENCY_SOURCE_NUM; i++) {
+        lat->hist[i].min_us = UINT32_MAX;
+    }
+}
+
+bool lamp_latency_input(lamp_latency_t *lat, uint8_t type, uint8_t source, int64_t input_us) {
+    if (type >= LAMP_CTRL_BUTT || source >= LAMP_LATENCY_SOURCE_NUM) {
+        return false;
+    }
+    lamp_latency_probe_t *probe = &lat->probe[type];
+    uint8_t stage = PROBE_EMPTY;
+
+    if (!__atomic_compare_exchange_n(&probe->stage, &stage, PROBE_FILLING, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add(&lat->hist[source].dropped, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    probe->input_us = input_us;
+    probe->source = source;
+    __atomic_store_n(&probe->stage, PROBE_ARMED, __ATOMIC_RELEASE);
+    return true;
+}
+
+void lamp_latency_applied(lamp_latency_t *lat, uint8_t type, bool published) {
+    if (type >= LAMP_CTRL_BUTT) {
+        return;
+    }
+    lamp_latency_probe_t *probe = &lat->probe[type];
+    if (PROBE_ARMED != __atomic_load_n(&probe->stage, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    if (!published) {
+        __atomic_fetch_add(&lat->hist[probe->source].dropped, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&probe->stage, PROBE_EMPTY, __ATOMIC_RELEASE);
+        return;
+    }
+
+    // the probe holds its generation before the renderer can see it
+    uint32_t gen = lat->gen + 1;
+    probe->gen = gen;
+    __atomic_store_n(&probe->stage, PROBE_APPLIED, __ATOMIC_RELEASE);
+    __atomic_store_n(&lat->gen, gen, __ATOMIC_RELEASE);
+}
+
+uint32_t lamp_latency_frame_begin(const lamp_latency_t *lat) {
+    return __atomic_load_n(&lat->gen, __ATOMIC_ACQUIRE);
+}
+
+static uint32_t latency_bin(uint32_t us) {
+    uint32_t ms = us / 1000;
+    uint32_t bin = 0;
+
+    while (ms && bin < LAMP_LATENCY_BINS - 1) {
+        ms >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+void lamp_latency_frame_commit(lamp_latency_t *lat, uint32_t gen, int64_t commit_us) {
+    for (uint32_t type = 0; type < LAMP_CTRL_BUTT; type++) {
+        lamp_latency_probe_t *probe = &lat->probe[type];
+        if (PROBE_APPLIED != __atomic_load_n(&probe->stage, __ATOMIC_ACQUIRE)
+            || (int32_t)(gen - probe->gen) < 0) {
+            // not published yet when this frame took its snapshot
+            continue;
+        }
+
+        int64_t delta = commit_us - probe->input_us;
+        uint32_t us = delta < 0 ? 0 : (delta > UINT32_MAX ? UINT32_MAX : (uint32_t)delta);
+        lamp_latency_hist_t *hist = &lat->hist[probe->source];
+        hist->bins[latency_bin(us)]++;
+        hist->count++;
+        hist->sum_us += us;
+        hist->min_us = us < hist->min_us ? us : hist->min_us;
+        hist->max_us = us > hist->max_us ? us : hist->max_us;
+        __atomic_store_n(&probe->stage, PROBE_EMPTY, __ATOMIC_RELEASE);
+    }
+}
+
+uint32_t lamp_latency_bin_us(uint32_t bin) {
+    return 0 == bin ? 0 : 1000U << (bin - 1);
+}
+
+uint32_t lamp_latency_percentile(const lamp_latency_hist_t *hist, uint32_t pct) {
+    if (0 == hist->count) {
+        return 0;
+    }
+    uint32_t want = (hist->count * pct + 99) / 100;
+    uint32_t seen = 0;
+
+    for (uint32_t bin = 0; bin < LAMP_LATENCY_BINS - 1; bin++) {
+        seen += hist->bins[bin];
+        if (seen >= want) {
+            return lamp_latency_bin_us(bin + 1);
+        }
+    }
+    return hist->max_us;
+}
+
+const char *lamp_latency_source_name(uint8_t source) {
+    return source < LAMP_LATENCY_SOURCE_NUM ? g_source_names[source] : "?";
+}
@@ -0,0 +1,108 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 23:02:14
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 23:02:17
+ * @FilePath    : /shellhome-nightlamp/main/lamp_latency.h
+ * @Description : input to photon latency probes, one histogram per input
+ *                source, no ESP-IDF dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_LATENCY_H
+#define LAMP_LATENCY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lamp_ctrl.h"
+
+#ifdef LAMP_HOST_BUILD
+#define CONFIG_LAMP_LATENCY     1
+#endif /* LAMP_HOST_BUILD */
+
+/*
+ * A probe lives in one slot per control event type and walks three stages:
+ *   input      the sensor side stamps the time of the physical input
+ *   applied    the control path published the params, the probe takes the
+ *              next generation
+ *   committed  the first frame rendered from a snapshot taken at or after
+ *              that generation is on the LEDs, the latency is recorded
+ * Inputs arriving while their slot is busy are merged into the running probe
+ * by the event group anyway, they count as dropped like the inputs the
+ * control path discards.
+ */
+typedef enum {
+    LAMP_LATENCY_BUTTON_1,              /*!< color button */
+    LAMP_LATENCY_BUTTON_2,              /*!< timer button */
+    LAMP_LATENCY_GESTURE,               /*!< recognized vibration gesture */
+    LAMP_LATENCY_KICK,                  /*!< single vibration hit */
+    LAMP_LATENCY_SOURCE_NUM
+} lamp_latency_source_t;
+
+/**< bin 0 below 1 ms, bin k from 2^(k-1) ms, the last one open ended */
+#define LAMP_LATENCY_BINS   14
+
+typedef struct {
+    uint32_t    bins[LAMP_LATENCY_BINS];
+    uint32_t                   count;
+    uint32_t                 dropped;   /*!< inputs without a measurement */
+    uint32_t                  min_us;
+    uint32_t                  max_us;
+    uint64_t                  sum_us;
+} lamp_latency_hist_t;
+
+typedef struct {
+    int64_t                 input_us;
+    uint32_t                     gen;   /*!< generation of the publish */
+    uint8_t                   source;
+    uint8_t                    stage;
+} lamp_latency_probe_t;
+
+typedef struct {
+    lamp_latency_probe_t    probe[LAMP_CTRL_BUTT];
+    uint32_t                     gen;   /*!< bumped by every publish */
+    lamp_latency_hist_t     hist[LAMP_LATENCY_SOURCE_NUM];
+} lamp_latency_t;
+
+#ifdef CONFIG_LAMP_LATENCY
+#define LAMP_LATENCY_INPUT(lat, type, source, us)   lamp_latency_input((lat), (type), (source), (us))
+#define LAMP_LATENCY_APPLIED(lat, type, published)  lamp_latency_applied((lat), (type), (published))
+#else
+#define LAMP_LATENCY_INPUT(lat, type, source, us)
+#define LAMP_LATENCY_APPLIED(lat, type, published)
+#endif
+
+void lamp_latency_init(lamp_latency_t *lat);
+
+// stamp an input that reaches the control path as event type, any task
+bool lamp_latency_input(lamp_latency_t *lat, uint8_t type, uint8_t source, int64_t input_us);
+
+// the control path handled event type, call after lamp_state_publish()
+void lamp_latency_applied(lamp_latency_t *lat, uint8_t type, bool published);
+
+// render path, before the state snapshot of a frame
+uint32_t lamp_latency_frame_begin(const lamp_latency_t *lat);
+
+// render path, once the frame started at gen is on the LEDs
+void lamp_latency_frame_commit(lamp_latency_t *lat, uint32_t gen, int64_t commit_us);
+
+// upper edge in us of the bin holding the pct percentile, 0 when empty
+uint32_t lamp_latency_percentile(const lamp_latency_hist_t *hist, uint32_t pct);
+
+// lower edge in us of a bin
+uint32_t lamp_latency_bin_us(uint32_t bin);
+
+const char *lamp_latency_source_name(uint8_t source);
+
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_LATENCY_H */
@@ -0,0 +1,214 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 19:03:10
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 19:03:13
+ * @FilePath    : /shellhome-nightlamp/main/lamp_layout.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "lamp_layout.h"
+
+static lamp_layout_t g_layout;
+/**< holds coordinates for every LED, static rather than on a stack */
+static lamp_layout_config_t g_config;
+
+void lamp_layout_default(lamp_layout_config_t *cfg, uint16_t num) {
+    memset(cfg, 0, sizeof(lamp_layout_config_t));
+    cfg->num = num > LAMP_STRIP_MAX ? LAMP_STRIP_MAX : num;
+    cfg->seg_num = 1;
+    cfg->seg[0].count = cfg->num;
+    for (uint16_t i = 0; i < cfg->num; i++) {
+        cfg->x[i] = i;
+    }
+}
+
+static inline uint16_t get_u16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+bool lamp_layout_parse(const uint8_t *blob, size_t len, lamp_layout_config_t *cfg) {
+    if (len < 6 || LAMP_LAYOUT_VERSION != blob[0]) {
+        return false;
+    }
+    memset(cfg, 0, sizeof(lamp_layout_config_t));
+    cfg->flags = blob[1];
+    cfg->num = get_u16(&blob[2]);
+    cfg->seg_num = blob[4];
+    if (0 == cfg->num || cfg->num > LAMP_STRIP_MAX
+        || 0 == cfg->seg_num || cfg->seg_num > LAMP_LAYOUT_SEG_MAX) {
+        return false;
+    }
+
+    size_t need = 6 + cfg->seg_num * 6;
+    if (cfg->flags & LAMP_LAYOUT_HAS_COORDS) {
+        need += cfg->num * 4;
+    }
+    if (len != need) {
+        return false;
+    }
+
+    // segments must cover num LEDs, each physical LED at most once
+    uint8_t used[LAMP_STRIP_MAX] = {0};
+    uint32_t total = 0;
+    const uint8_t *p = &blob[6];
+    for (uint8_t s = 0; s < cfg->seg_num; s++, p += 6) {
+        lamp_layout_segment_t *seg = &cfg->seg[s];
+        seg->start = get_u16(&p[0]);
+        seg->count = get_u16(&p[2]);
+        seg->reverse = p[4] ? 1 : 0;
+        if (0 == seg->count || seg->start + seg->count > LAMP_STRIP_MAX) {
+            return false;
+        }
+        for (uint16_t k = seg->start; k < seg->start + seg->count; k++) {
+            if (used[k]++) {
+                return false;
+            }
+        }
+        total += seg->count;
+    }
+    if (total != cfg->num) {
+        return false;
+    }
+
+    if (cfg->flags & LAMP_LAYOUT_HAS_COORDS) {
+        for (uint16_t i = 0; i < cfg->num; i++, p += 4) {
+            cfg->x[i] = (int16_t)get_u16(&p[0]);
+            cfg->y[i] = (int16_t)get_u16(&p[2]);
+        }
+    } else {
+        for (uint16_t i = 0; i < cfg->num; i++) {
+            cfg->x[i] = i;
+        }
+    }
+    return true;
+}
+
+static inline void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+size_t lamp_layout_pack(const lamp_layout_config_t *cfg, uint8_t *blob) {
+    uint8_t *p = blob;
+
+    p[0] = LAMP_LAYOUT_VERSION;
+    p[1] = cfg->flags;
+    put_u16(&p[2], cfg->num);
+    p[4] = cfg->seg_num;
+    p[5] = 0;
+    p += 6;
+    for (uint8_t s = 0; s < cfg->seg_num; s++, p += 6) {
+        put_u16(&p[0], cfg->seg[s].start);
+        put_u16(&p[2], cfg->seg[s].count);
+        p[4] = cfg->seg[s].reverse;
+        p[5] = 0;
+    }
+    if (cfg->flags & LAMP_LAYOUT_HAS_COORDS) {
+        for (uint16_t i = 0; i < cfg->num; i++, p += 4) {
+            put_u16(&p[0], (uint16_t)cfg->x[i]);
+            put_u16(&p[2], (uint16_t)cfg->y[i]);
+        }
+    }
+    return p - blob;
+}
+
+static void layout_neighbors(lamp_layout_t *layout, const lamp_layout_config_t *cfg) {
+    for (uint16_t i = 0; i < cfg->num; i++) {
+        int64_t best[LAMP_LAYOUT_NB];
+        for (int k = 0; k < LAMP_LAYOUT_NB; k++) {
+            best[k] = INT64_MAX;
+            layout->nb[i][k] = i;
+        }
+        for (uint16_t j = 0; j < cfg->num; j++) {
+            if (j == i) {
+                continue;
+            }
+            int64_t dx = cfg->x[j] - cfg->x[i];
+            int64_t dy = cfg->y[j] - cfg->y[i];
+            int64_t d = dx * dx + dy * dy;
+            // insertion into the short sorted list
+            for (int k = 0; k < LAMP_LAYOUT_NB; k++) {
+                if (d < best[k]) {
+                    for (int m = LAMP_LAYOUT_NB - 1; m > k; m--) {
+                        best[m] = best[m - 1];
+                        layout->nb[i][m] = layout->nb[i][m - 1];
+                    }
+                    best[k] = d;
+                    layout->nb[i][k] = j;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void lamp_layout_build(const lamp_layout_config_t *cfg) {
+    lamp_layout_t *layout = &g_layout;
+
+    memset(layout, 0, sizeof(lamp_layout_t));
+    layout->num = cfg->num;
+    layout->flags = cfg->flags;
+
+    uint16_t i = 0;
+    for (uint8_t s = 0; s < cfg->seg_num; s++) {
+        const lamp_layout_segment_t *seg = &cfg->seg[s];
+        for (uint16_t k = 0; k < seg->count && i < cfg->num; k++) {
+            layout->phys[i++] = seg->reverse ? seg->start + seg->count - 1 - k
+                                             : seg->start + k;
+        }
+    }
+    layout->in_order = true;
+    memset(layout->logical, 0xff, sizeof(layout->logical));
+    for (i = 0; i < cfg->num; i++) {
+        layout->logical[layout->phys[i]] = i;
+        layout->span = layout->phys[i] >= layout->span ? layout->phys[i] + 1 : layout->span;
+        layout->in_order &= layout->phys[i] == i;
+    }
+
+    // polar coordinates around the centroid, the only trigonometry there is
+    float cx = 0.0f, cy = 0.0f;
+    for (i = 0; i < cfg->num; i++) {
+        cx += cfg->x[i];
+        cy += cfg->y[i];
+    }
+    cx /= cfg->num;
+    cy /= cfg->num;
+
+    float rmax = 0.0f;
+    for (i = 0; i < cfg->num; i++) {
+        float dx = cfg->x[i] - cx;
+        float dy = cfg->y[i] - cy;
+        float a = atan2f(dy, dx);
+        if (a < 0.0f) {
+            a += 2.0f * (float)M_PI;
+        }
+        layout->angle[i] = (uint8_t)((uint32_t)(a * 256.0f / (2.0f * (float)M_PI)) & 0xff);
+        float r = sqrtf(dx * dx + dy * dy);
+        rmax = r > rmax ? r : rmax;
+    }
+    for (i = 0; i < cfg->num && rmax > 0.0f; i++) {
+        float dx = cfg->x[i] - cx;
+        float dy = cfg->y[i] - cy;
+        layout->radius[i] = (uint8_t)(sqrtf(dx * dx + dy * dy) * 255.0f / rmax + 0.5f);
+    }
+
+    layout_neighbors(layout, cfg);
+}
+
+const lamp_layout_t *lamp_layout(void) {
+    if (0 == g_layout.num) {
+        lamp_layout_default(&g_config, LAMP_STRIP_MAX);
+        lamp_layout_build(&g_config);
+    }
+    return &g_layout;
+}
+
+lamp_layout_config_t *lamp_layout_config(void) {
+    return &g_config;
+}
@@ -0,0 +1,108 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 19:02:44
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 19:02:47
+ * @FilePath    : /shellhome-nightlamp/main/lamp_layout.h
+ * @Description : runtime LED layout with precomputed spatial tables, no
+ *                ESP-IDF dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_LAYOUT_H
+#define LAMP_LAYOUT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "lamp_frame.h"
+
+#define LAMP_LAYOUT_VERSION     1
+#define LAMP_LAYOUT_SEG_MAX     8
+#define LAMP_LAYOUT_NB          2       /**< neighbors kept per LED */
+
+/* flags */
+#define LAMP_LAYOUT_HAS_COORDS  (1 << 0)
+
+#define LAMP_LAYOUT_NONE        UINT16_MAX  /**< physical LED no logical one drives */
+
+/**< largest blob of a layout that fits LAMP_STRIP_MAX */
+#define LAMP_LAYOUT_BLOB_MAX    (6 + LAMP_LAYOUT_SEG_MAX * 6 + LAMP_STRIP_MAX * 4)
+
+/**
+ * @brief A run of physical LEDs, logical LEDs are the segments in order
+ *
+ */
+typedef struct {
+    uint16_t                   start;   /*!< first physical LED */
+    uint16_t                   count;
+    uint8_t                  reverse;   /*!< run from start + count - 1 down */
+} lamp_layout_segment_t;
+
+/**
+ * @brief Layout as stored in NVS
+ *
+ * Blob, little endian: version u8, flags u8, num u16, seg_num u8, pad u8,
+ * then seg_num times {start u16, count u16, reverse u8, pad u8}, then with
+ * LAMP_LAYOUT_HAS_COORDS num times {x i16, y i16} in any unit
+ *
+ */
+typedef struct {
+    uint8_t                    flags;
+    uint16_t                     num;   /*!< logical LEDs */
+    uint8_t                  seg_num;
+    lamp_layout_segment_t seg[LAMP_LAYOUT_SEG_MAX];
+    int16_t        x[LAMP_STRIP_MAX];
+    int16_t        y[LAMP_STRIP_MAX];
+} lamp_layout_config_t;
+
+/**
+ * @brief Lookup tables built from a layout, indexed by logical LED but for
+ *        logical
+ *
+ */
+typedef struct {
+    uint16_t                     num;
+    uint8_t                    flags;
+    uint16_t                    span;   /*!< physical LEDs to send, highest phys + 1 */
+    bool                    in_order;   /*!< phys[i] == i for every LED */
+    uint16_t    phys[LAMP_STRIP_MAX];   /*!< physical LED */
+    uint16_t logical[LAMP_STRIP_MAX];   /*!< by physical LED, the inverse of phys */
+    uint8_t    angle[LAMP_STRIP_MAX];   /*!< around the centroid, 256 per turn */
+    uint8_t   radius[LAMP_STRIP_MAX];   /*!< from the centroid, 255 the farthest */
+    uint16_t nb[LAMP_STRIP_MAX][LAMP_LAYOUT_NB];    /*!< nearest LEDs */
+} lamp_layout_t;
+
+// single segment straight line of num LEDs
+void lamp_layout_default(lamp_layout_config_t *cfg, uint16_t num);
+
+/**
+ * @brief Parse and check a layout blob
+ *
+ * @return false when the blob is malformed or does not fit LAMP_STRIP_MAX
+ */
+bool lamp_layout_parse(const uint8_t *blob, size_t len, lamp_layout_config_t *cfg);
+
+// blob of a layout as lamp_layout_parse() reads it, at most LAMP_LAYOUT_BLOB_MAX
+size_t lamp_layout_pack(const lamp_layout_config_t *cfg, uint8_t *blob);
+
+// build the lookup tables of a checked layout and make it current
+void lamp_layout_build(const lamp_layout_config_t *cfg);
+
+// static config to parse into before a build, it keeps the one built last
+lamp_layout_config_t *lamp_layout_config(void);
+
+// current layout, the default line of LAMP_STRIP_MAX LEDs until one is built
+const lamp_layout_t *lamp_layout(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_LAYOUT_H */
@@ -0,0 +1,109 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 17:05:58
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 17:06:01
+ * @FilePath    : /shellhome-nightlamp/main/lamp_particle.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <string.h>
+
+#include "lamp_particle.h"
+
+void lamp_particle_init(lamp_particle_pool_t *pool) {
+    pool->live = 0;
+    memset(&pool->stats, 0, sizeof(lamp_particle_stats_t));
+}
+
+bool lamp_particle_spawn(lamp_particle_pool_t *pool, const lamp_particle_config_t *cfg) {
+    if (pool->live >= LAMP_PARTICLE_MAX || 0 == cfg->life) {
+        pool->stats.failed++;
+        return false;
+    }
+
+    uint16_t i = pool->live++;
+    pool->pos[i] = cfg->pos;
+    pool->vel[i] = cfg->vel;
+    pool->acc[i] = cfg->acc;
+    pool->life[i] = cfg->life;
+    pool->fade[i] = 65535 / cfg->life;
+    pool->tail[i] = cfg->tail;
+    pool->color[i] = cfg->color;
+
+    pool->stats.spawned++;
+    if (pool->live > pool->stats.peak) {
+        pool->stats.peak = pool->live;
+    }
+    return true;
+}
+
+/**< move the last live particle into slot i */
+static inline void particle_retire(lamp_particle_pool_t *pool, uint16_t i) {
+    uint16_t last = --pool->live;
+
+    pool->pos[i] = pool->pos[last];
+    pool->vel[i] = pool->vel[last];
+    pool->acc[i] = pool->acc[last];
+    pool->life[i] = pool->life[last];
+    pool->fade[i] = pool->fade[last];
+    pool->tail[i] = pool->tail[last];
+    pool->color[i] = pool->color[last];
+    pool->stats.retired++;
+}
+
+void lamp_particle_update(lamp_particle_pool_t *pool, int32_t num) {
+    int32_t live = pool->live;
+
+    // integrate first, the arrays stay independent so the loops stay simple
+    for (int32_t i = 0; i < live; i++) {
+        pool->pos[i] += pool->vel[i];
+        pool->vel[i] += pool->acc[i];
+        pool->life[i]--;
+    }
+
+    for (int32_t i = 0; i < pool->live; ) {
+        int32_t px = pool->pos[i] >> 16;
+        int32_t margin = pool->tail[i] + 1;
+        if (0 == pool->life[i] || px < -margin || px >= num + margin) {
+            particle_retire(pool, i);
+        } else {
+            i++;
+        }
+    }
+}
+
+static inline void add_pixel(lamp_frame_t *frame, int32_t px,
+                             const lamp_rgb_t *color, uint32_t level) {
+    if (px < 0 || px >= LAMP_STRIP_MAX || 0 == level) {
+        return;
+    }
+    lamp_rgb_t *dst = &frame->strip[px];
+    uint32_t r = dst->r + ((color->r * level) >> 8);
+    uint32_t g = dst->g + ((color->g * level) >> 8);
+    uint32_t b = dst->b + ((color->b * level) >> 8);
+    dst->r = r > 255 ? 255 : r;
+    dst->g = g > 255 ? 255 : g;
+    dst->b = b > 255 ? 255 : b;
+}
+
+void lamp_particle_render(const lamp_particle_pool_t *pool, lamp_frame_t *frame) {
+    for (uint16_t i = 0; i < pool->live; i++) {
+        uint32_t level = ((uint32_t)pool->life[i] * pool->fade[i]) >> 8;
+        level = level > 256 ? 256 : level;
+        int32_t px = pool->pos[i] >> 16;
+        uint32_t frac = (pool->pos[i] >> 8) & 0xff;
+
+        // head spread over two pixels for sub-pixel motion
+        add_pixel(frame, px, &pool->color[i], (level * (256 - frac)) >> 8);
+        add_pixel(frame, px + 1, &pool->color[i], (level * frac) >> 8);
+
+        // tail fades linearly behind the head
+        int32_t dir = pool->vel[i] >= 0 ? -1 : 1;
+        uint32_t step = level / (pool->tail[i] + 1);
+        for (int32_t t = 1; t <= pool->tail[i]; t++) {
+            add_pixel(frame, px + dir * t, &pool->color[i], level - step * t);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 17:05:40
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 17:05:43
+ * @FilePath    : /shellhome-nightlamp/main/lamp_particle.h
+ * @Description : fixed size particle pool in structure of arrays layout, no
+ *                ESP-IDF dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_PARTICLE_H
+#define LAMP_PARTICLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lamp_frame.h"
+
+#ifdef LAMP_HOST_BUILD
+#ifndef CONFIG_LAMP_PARTICLE_NUM
+#define CONFIG_LAMP_PARTICLE_NUM    64
+#endif
+#endif /* LAMP_HOST_BUILD */
+
+#define LAMP_PARTICLE_MAX   CONFIG_LAMP_PARTICLE_NUM
+
+/* positions and speeds are in pixels, 16.16 fixed point */
+#define LAMP_PARTICLE_ONE   (1 << 16)
+
+/**
+ * @brief Particle Configuration Type, one spawn
+ *
+ */
+typedef struct {
+    int32_t                      pos;   /*!< pixel position */
+    int32_t                      vel;   /*!< pixels per frame */
+    int32_t                      acc;   /*!< pixels per frame^2 */
+    uint16_t                    life;   /*!< frames to live */
+    uint8_t                     tail;   /*!< pixels of fading tail */
+    lamp_rgb_t                 color;
+} lamp_particle_config_t;
+
+typedef struct {
+    uint32_t                 spawned;
+    uint32_t                  failed;   /*!< spawns refused on a full pool */
+    uint32_t                 retired;
+    uint16_t                    peak;   /*!< highest live count */
+} lamp_particle_stats_t;
+
+/**
+ * @brief Particle pool, live particles are packed at the front of every
+ *        array so update and render walk contiguous memory
+ *
+ */
+typedef struct {
+    int32_t       pos[LAMP_PARTICLE_MAX];
+    int32_t       vel[LAMP_PARTICLE_MAX];
+    int32_t       acc[LAMP_PARTICLE_MAX];
+    uint16_t     life[LAMP_PARTICLE_MAX];
+    uint16_t     fade[LAMP_PARTICLE_MAX];   /*!< 65535 / initial life */
+    uint8_t      tail[LAMP_PARTICLE_MAX];
+    lamp_rgb_t  color[LAMP_PARTICLE_MAX];
+    uint16_t                    live;
+    lamp_particle_stats_t      stats;
+} lamp_particle_pool_t;
+
+// empty the pool and its counters
+void lamp_particle_init(lamp_particle_pool_t *pool);
+
+// spawn one particle, false when the pool is full
+bool lamp_particle_spawn(lamp_particle_pool_t *pool, const lamp_particle_config_t *cfg);
+
+/**
+ * @brief Move all particles by one frame, retiring those out of life or
+ *        beyond the strip
+ *
+ */
+void lamp_particle_update(lamp_particle_pool_t *pool, int32_t num);
+
+// add all particles onto the strip of a frame, saturating
+void lamp_particle_render(const lamp_particle_pool_t *pool, lamp_frame_t *frame);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_PARTICLE_H */
@@ -0,0 +1,217 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 15:30:58
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 15:31:01
+ * @FilePath    : /shellhome-nightlamp/main/lamp_record.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <string.h>
+
+#include "lamp_record.h"
+#include "lamp_tier.h"
+
+#ifdef CONFIG_LAMP_RECORD
+
+static lamp_record_t g_records[CONFIG_LAMP_RECORD_NUM];
+/**< head + 1 of the record in each slot once written, 0 while it is written */
+static uint32_t g_record_seq[CONFIG_LAMP_RECORD_NUM];
+static uint32_t g_record_head = 0;      /**< records ever added */
+static uint32_t g_record_tail = 0;      /**< first record of the capture */
+
+void lamp_record_add(uint32_t ts_ms, uint8_t type, uint8_t a, uint16_t b, uint32_t c) {
+    uint32_t head = __atomic_fetch_add(&g_record_head, 1, __ATOMIC_RELAXED);
+    uint32_t slot = head % CONFIG_LAMP_RECORD_NUM;
+    lamp_record_t *rec = &g_records[slot];
+
+    __atomic_store_n(&g_record_seq[slot], 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    rec->ts_ms = ts_ms;
+    rec->type = type;
+    rec->a = a;
+    rec->b = b;
+    rec->c = c;
+    // written last, a reader takes the slot only for its own sequence
+    __atomic_store_n(&g_record_seq[slot], head + 1, __ATOMIC_RELEASE);
+}
+
+void lamp_record_clear(void) {
+    // writers keep going, the capture starts at the next record they add
+    __atomic_store_n(&g_record_tail, __atomic_load_n(&g_record_head, __ATOMIC_ACQUIRE),
+                     __ATOMIC_RELEASE);
+}
+
+size_t lamp_record_copy(lamp_record_t *out, size_t max, bool *wrapped) {
+    uint32_t head = __atomic_load_n(&g_record_head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&g_record_tail, __ATOMIC_ACQUIRE);
+    uint32_t from = head - tail > CONFIG_LAMP_RECORD_NUM ? head - CONFIG_LAMP_RECORD_NUM : tail;
+    bool lost = from != tail;
+    size_t copied = 0;
+
+    for (uint32_t i = from; i != head && copied < max; i++) {
+        uint32_t slot = i % CONFIG_LAMP_RECORD_NUM;
+        uint32_t seq = __atomic_load_n(&g_record_seq[slot], __ATOMIC_ACQUIRE);
+        if (i + 1 != seq) {
+            if (0 == seq) {
+                // still being written, the capture ends here
+                break;
+            }
+            lost = true;
+            continue;
+        }
+        out[copied] = g_records[slot];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (i + 1 != __atomic_load_n(&g_record_seq[slot], __ATOMIC_RELAXED)) {
+            // a wrapping writer took the slot while it was copied
+            lost = true;
+            continue;
+        }
+        copied++;
+    }
+    if (NULL != wrapped) {
+        *wrapped = lost;
+    }
+    return copied;
+}
+
+size_t lamp_record_size(void) {
+    return sizeof(g_records) + sizeof(g_record_seq);
+}
+
+#else
+
+void lamp_record_add(uint32_t ts_ms, uint8_t type, uint8_t a, uint16_t b, uint32_t c) {
+}
+
+void lamp_record_clear(void) {
+}
+
+size_t lamp_record_copy(lamp_record_t *out, size_t max, bool *wrapped) {
+    if (NULL != wrapped) {
+        *wrapped = false;
+    }
+    return 0;
+}
+
+size_t lamp_record_size(void) {
+    return 0;
+}
+
+#endif /* CONFIG_LAMP_RECORD */
+
+uint32_t lamp_frame_checksum(const lamp_frame_t *frame) {
+    /**< FNV-1a */
+    const uint8_t *p = (const uint8_t *)frame;
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < sizeof(lamp_frame_t); i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t lamp_record_pack_params(const lamp_params_t *params) {
+    return (uint32_t)params->saturation |
+           ((uint32_t)params->value << 8) |
+           ((uint32_t)(params->power ? 1 : 0) << 16) |
+           ((uint32_t)(params->kick & 0x7f) << 17) |
+           ((params->epoch & 0xff) << 24);
+}
+
+void lamp_record_unpack_params(const lamp_record_t *rec, lamp_params_t *params) {
+    params->lamp_mode = rec->a;
+    params->hue = rec->b;
+    params->saturation = rec->c & 0xff;
+    params->value = (rec->c >> 8) & 0xff;
+    params->power = (rec->c >> 16) & 0x01;
+    params->kick = (rec->c >> 17) & 0x7f;
+    params->epoch = rec->c >> 24;
+}
+
+static bool params_equal(const lamp_params_t *a, const lamp_params_t *b) {
+    return a->lamp_mode == b->lamp_mode && a->hue == b->hue &&
+           a->saturation == b->saturation && a->value == b->value &&
+           a->power == b->power && a->kick == b->kick;
+}
+
+uint32_t lamp_replay_run(const lamp_record_t *records, size_t num,
+                         const lamp_render_config_t *cfg,
+                         lamp_replay_result_t *result,
+                         lamp_replay_frame_cb_t cb, void *arg) {
+    static lamp_render_t render;
+    lamp_params_t ctrl = {0};
+    lamp_params_t params = {0};
+    uint8_t tier = LAMP_TIER_FULL;
+    bool seeded = false;
+
+    memset(result, 0, sizeof(lamp_replay_result_t));
+    lamp_render_init(&render, cfg);
+
+    for (size_t i = 0; i < num; i++) {
+        const lamp_record_t *rec = &records[i];
+
+        switch (rec->type) {
+            case LAMP_RECORD_PARAMS:
+                lamp_record_unpack_params(rec, &params);
+                if (!seeded) {
+                    // the capture starts from these parameters
+                    ctrl = params;
+                    seeded = true;
+                } else if (!params_equal(&ctrl, &params)) {
+                    result->state_mismatches++;
+                    ctrl = params;
+                }
+                break;
+
+            case LAMP_RECORD_CTRL:
+                if (seeded) {
+                    lamp_ctrl_event_t event = {
+                        .type = rec->a,
+                        .hue = rec->b,
+                        .saturation = rec->c,
+                    };
+                    lamp_ctrl_apply(&ctrl, &event);
+                    result->events++;
+                }
+                break;
+
+            case LAMP_RECORD_FRAME:
+                if (seeded) {
+                    uint32_t interval;
+                    lamp_params_t shown = params;
+                    lamp_tier_params(tier, &shown);
+                    const lamp_frame_t *frame = lamp_render_frame(&render, &shown,
+                                                                  rec->ts_ms, &interval);
+                    bool match = lamp_frame_checksum(frame) == rec->c;
+                    if (!match) {
+                        if (0 == result->frame_mismatches) {
+                            result->first_mismatch = result->frames;
+                        }
+                        result->frame_mismatches++;
+                    }
+                    if (NULL != cb) {
+                        cb(result->frames, rec->ts_ms, frame, match, arg);
+                    }
+                    result->frames++;
+                }
+                break;
+
+            case LAMP_RECORD_TIER:
+                tier = rec->a;
+                break;
+
+            case LAMP_RECORD_BUTTON:
+            case LAMP_RECORD_GESTURE:
+            case LAMP_RECORD_TIMER:
+                result->inputs++;
+                break;
+
+            default:
+                break;
+        }
+    }
+    return result->frame_mismatches + result->state_mismatches;
+}
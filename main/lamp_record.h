@@ -0,0 +1,125 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 15:30:44
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 15:30:47
+ * @FilePath    : /shellhome-nightlamp/main/lamp_record.h
+ * @Description : input and frame recorder with a replayer that also builds
+ *                on the host
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_RECORD_H
+#define LAMP_RECORD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "lamp_state.h"
+#include "lamp_frame.h"
+#include "lamp_ctrl.h"
+#include "lamp_render.h"
+
+#ifdef LAMP_HOST_BUILD
+#ifndef CONFIG_LAMP_RECORD_NUM
+#define CONFIG_LAMP_RECORD_NUM  512
+#endif
+#define CONFIG_LAMP_RECORD      1
+#endif /* LAMP_HOST_BUILD */
+
+typedef enum {
+    LAMP_RECORD_NONE,
+    LAMP_RECORD_BUTTON,         /*!< a: button */
+    LAMP_RECORD_GESTURE,        /*!< a: lamp_gesture_t */
+    LAMP_RECORD_TIMER,          /*!< a: 0 save timer, 1 off timer */
+    LAMP_RECORD_CTRL,           /*!< a: type, b: hue, c: saturation */
+    LAMP_RECORD_PARAMS,         /*!< a: mode, b: hue, c: see lamp_record_pack_params() */
+    LAMP_RECORD_FRAME,          /*!< c: frame checksum */
+    LAMP_RECORD_TIER,           /*!< a: lamp_tier_level_t the frames after it render at */
+    LAMP_RECORD_BUTT
+} lamp_record_type_t;
+
+#define LAMP_RECORD_TIMER_SAVE  0
+#define LAMP_RECORD_TIMER_OFF   1
+
+/**
+ * @brief One recorded event, 12 bytes
+ *
+ */
+typedef struct {
+    uint32_t                   ts_ms;
+    uint8_t                     type;
+    uint8_t                        a;
+    uint16_t                       b;
+    uint32_t                       c;
+} lamp_record_t;
+
+typedef struct {
+    uint32_t                  frames;   /*!< frames rendered */
+    uint32_t         frame_mismatches;
+    uint32_t          first_mismatch;   /*!< index of the first bad frame */
+    uint32_t                  events;   /*!< control events applied */
+    uint32_t         state_mismatches;  /*!< control state differing from the recorded params */
+    uint32_t                  inputs;   /*!< raw input records seen */
+} lamp_replay_result_t;
+
+typedef void (*lamp_replay_frame_cb_t)(uint32_t index, uint32_t ts_ms,
+                                       const lamp_frame_t *frame,
+                                       bool match, void *arg);
+
+#ifdef CONFIG_LAMP_RECORD
+#define LAMP_RECORD(ts_ms, type, a, b, c)   lamp_record_add((ts_ms), (type), (a), (b), (c))
+#else
+#define LAMP_RECORD(ts_ms, type, a, b, c)
+#endif
+
+// append a record to the ring, safe from any task
+void lamp_record_add(uint32_t ts_ms, uint8_t type, uint8_t a, uint16_t b, uint32_t c);
+
+// start a new capture, records added from now on
+void lamp_record_clear(void);
+
+/**
+ * @brief Copy the capture oldest first, skipping slots a writer rewrote
+ *        during the copy
+ *
+ * @param wrapped: set when records of the capture were overwritten
+ *
+ * @return number of records copied
+ */
+size_t lamp_record_copy(lamp_record_t *out, size_t max, bool *wrapped);
+
+// bytes of the ring, 0 when disabled
+size_t lamp_record_size(void);
+
+// checksum of a frame for LAMP_RECORD_FRAME
+uint32_t lamp_frame_checksum(const lamp_frame_t *frame);
+
+// pack saturation, value, power, kick and epoch of params for LAMP_RECORD_PARAMS
+uint32_t lamp_record_pack_params(const lamp_params_t *params);
+
+// unpack a LAMP_RECORD_PARAMS record
+void lamp_record_unpack_params(const lamp_record_t *rec, lamp_params_t *params);
+
+/**
+ * @brief Replay a capture, driving the control state machine with the
+ *        recorded events and a fresh renderer with the recorded frame times
+ *
+ * @return number of frame and state mismatches, 0 when the replay matched
+ */
+uint32_t lamp_replay_run(const lamp_record_t *records, size_t num,
+                         const lamp_render_config_t *cfg,
+                         lamp_replay_result_t *result,
+                         lamp_replay_frame_cb_t cb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_RECORD_H */
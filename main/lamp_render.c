@@ -0,0 +1,148 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 13:41:07
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 13:41:10
+ * @FilePath    : /shellhome-nightlamp/main/lamp_render.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "lamp_render.h"
+
+void lamp_frame_blend(lamp_frame_t *out, const lamp_frame_t *from,
+                      const lamp_frame_t *to, uint32_t alpha) {
+    const uint8_t *a = (const uint8_t *)from;
+    const uint8_t *b = (const uint8_t *)to;
+    uint8_t *o = (uint8_t *)out;
+    const size_t n = sizeof(lamp_frame_t);
+    const uint32_t inv = 256 - alpha;
+    size_t i = 0;
+
+    /**< two 8-bit lanes per multiply, four bytes per iteration */
+    for (; i + 4 <= n; i += 4) {
+        uint32_t x, y, z;
+        memcpy(&x, a + i, 4);
+        memcpy(&y, b + i, 4);
+        uint32_t rb = (x & 0x00ff00ff) * inv + (y & 0x00ff00ff) * alpha;
+        uint32_t ag = ((x >> 8) & 0x00ff00ff) * inv + ((y >> 8) & 0x00ff00ff) * alpha;
+        z = ((rb >> 8) & 0x00ff00ff) | (ag & 0xff00ff00);
+        memcpy(o + i, &z, 4);
+    }
+    for (; i < n; i++) {
+        o[i] = (a[i] * inv + b[i] * alpha) >> 8;
+    }
+}
+
+static bool params_changed(const lamp_params_t *a, const lamp_params_t *b) {
+    return a->epoch != b->epoch || a->lamp_mode != b->lamp_mode ||
+           a->power != b->power || a->hue != b->hue ||
+           a->saturation != b->saturation || a->value != b->value;
+}
+
+static inline bool is_due(uint32_t due_ms, uint32_t now_ms) {
+    return (int32_t)(now_ms - due_ms) >= 0;
+}
+
+static void render_effect(lamp_effect_t *fx, const lamp_params_t *params,
+                          lamp_frame_t *frame, uint32_t *due_ms, uint8_t *idle,
+                          uint32_t now_ms) {
+    uint32_t interval;
+
+    if (params->power) {
+        interval = lamp_effect_render(fx, params, now_ms, frame);
+    } else {
+        lamp_frame_clear(frame);
+        interval = LAMP_EFFECT_IDLE;
+    }
+
+    // a static frame is not rendered again until the parameters change
+    *idle = LAMP_EFFECT_IDLE == interval;
+    if (*idle) {
+        return;
+    }
+
+    // keep the cadence of the effect unless it fell behind
+    *due_ms += interval;
+    if (is_due(*due_ms, now_ms)) {
+        *due_ms = now_ms + interval;
+    }
+}
+
+void lamp_render_init(lamp_render_t *render, const lamp_render_config_t *cfg) {
+    memset(render, 0, sizeof(lamp_render_t));
+    render->cfg = *cfg;
+}
+
+const lamp_frame_t *lamp_render_frame(lamp_render_t *render,
+                                      const lamp_params_t *params,
+                                      uint32_t now_ms, uint32_t *interval) {
+    if (!render->started) {
+        render->started = 1;
+        render->params = *params;
+        lamp_effect_start(&render->fx, params);
+        render->due_ms = now_ms;
+    } else if (params_changed(params, &render->params)) {
+        if (render->cfg.fade_ms) {
+            // fade out from what is on the LEDs right now
+            if (render->fading) {
+                memcpy(&render->from_frame, &render->out, sizeof(lamp_frame_t));
+                render->from_frozen = 1;
+            } else {
+                render->from_fx = render->fx;
+                render->from_params = render->params;
+                render->from_due_ms = render->due_ms;
+                render->from_idle = render->idle;
+                memcpy(&render->from_frame, &render->frame, sizeof(lamp_frame_t));
+                render->from_frozen = 0;
+            }
+            render->fading = 1;
+            render->fade_start_ms = now_ms;
+        }
+        if (params->epoch != render->params.epoch) {
+            lamp_effect_start(&render->fx, params);
+        }
+        render->params = *params;
+        render->due_ms = now_ms;
+        render->idle = 0;
+    }
+    // the shared clock steps once when it locks, never wait out a step back
+    if (!render->idle && (int32_t)(render->due_ms - now_ms) > LAMP_RENDER_MAX_MS) {
+        render->due_ms = now_ms;
+    }
+
+    // hits feed the running effect without starting a crossfade
+    render->params.kick = params->kick;
+
+    if (!render->idle && is_due(render->due_ms, now_ms)) {
+        render_effect(&render->fx, &render->params, &render->frame,
+                      &render->due_ms, &render->idle, now_ms);
+    }
+    *interval = render->idle ? LAMP_RENDER_IDLE : render->due_ms - now_ms;
+
+    uint32_t elapsed = now_ms - render->fade_start_ms;
+    if (!render->fading || elapsed >= render->cfg.fade_ms) {
+        render->fading = 0;
+        return &render->frame;
+    }
+
+    if (!render->from_frozen && !render->from_idle && is_due(render->from_due_ms, now_ms)) {
+        render_effect(&render->from_fx, &render->from_params,
+                      &render->from_frame, &render->from_due_ms,
+                      &render->from_idle, now_ms);
+    }
+
+    // both effects keep their own cadence, the blend runs at a steady rate
+    lamp_frame_blend(&render->out, &render->from_frame, &render->frame,
+                     (elapsed << 8) / render->cfg.fade_ms);
+    *interval = render->cfg.step_ms;
+    return &render->out;
+}
+
+const lamp_effect_t *lamp_render_effect(const lamp_render_t *render) {
+    return &render->fx;
+}
@@ -0,0 +1,93 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 13:40:51
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 13:40:54
+ * @FilePath    : /shellhome-nightlamp/main/lamp_render.h
+ * @Description : renderer with crossfade between effects, no ESP-IDF dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_RENDER_H
+#define LAMP_RENDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+
+#include "lamp_state.h"
+#include "lamp_frame.h"
+#include "lamp_effect.h"
+
+// longest interval of any effect
+#define LAMP_RENDER_MAX_MS  1000
+
+// interval when the frame stays until the parameters change
+#define LAMP_RENDER_IDLE    LAMP_EFFECT_IDLE
+
+/**
+* @brief Renderer Configuration Type
+*
+*/
+typedef struct {
+    uint32_t             fade_ms;   /*!< crossfade duration, 0 cuts at once */
+    uint32_t             step_ms;   /*!< frame interval while fading */
+} lamp_render_config_t;
+
+typedef struct {
+    lamp_render_config_t     cfg;
+    lamp_params_t         params;   /*!< parameters of the incoming effect */
+    lamp_params_t    from_params;   /*!< parameters of the outgoing effect */
+    lamp_effect_t             fx;   /*!< incoming effect */
+    lamp_effect_t        from_fx;   /*!< outgoing effect */
+    uint32_t              due_ms;
+    uint32_t         from_due_ms;
+    uint32_t       fade_start_ms;
+    uint8_t              started;
+    uint8_t               fading;
+    uint8_t          from_frozen;   /*!< outgoing frame is a snapshot */
+    uint8_t                 idle;   /*!< incoming frame is static */
+    uint8_t            from_idle;
+    lamp_frame_t           frame;   /*!< last frame of the incoming effect */
+    lamp_frame_t      from_frame;   /*!< last frame of the outgoing effect */
+    lamp_frame_t             out;   /*!< blended frame */
+} lamp_render_t;
+
+// init renderer
+void lamp_render_init(lamp_render_t *render, const lamp_render_config_t *cfg);
+
+/**
+ * @brief Render the frame to show at now_ms
+ *
+ * @param render: renderer
+ * @param params: parameters snapshot of this frame
+ * @param now_ms: current time in ms
+ * @param interval: ms until the next frame is due, LAMP_RENDER_IDLE when
+ *                  nothing changes before the parameters do
+ *
+ * @return frame to send to the LEDs
+ */
+const lamp_frame_t *lamp_render_frame(lamp_render_t *render,
+                                      const lamp_params_t *params,
+                                      uint32_t now_ms, uint32_t *interval);
+
+// effect currently fading in or shown
+const lamp_effect_t *lamp_render_effect(const lamp_render_t *render);
+
+/**
+ * @brief Blend two frames, out = from + (to - from) * alpha / 256
+ *
+ * @param alpha: weight of to in [0, 256]
+ *
+ */
+void lamp_frame_blend(lamp_frame_t *out, const lamp_frame_t *from,
+                      const lamp_frame_t *to, uint32_t alpha);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_RENDER_H */
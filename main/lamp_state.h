@@ -0,0 +1,88 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 10:40:08
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 10:40:11
+ * @FilePath    : /shellhome-nightlamp/main/lamp_state.h
+ * @Description :
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_STATE_H
+#define LAMP_STATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <string.h>
+
+typedef enum {
+    LAMP_MODE_MARQUEE,
+    LAMP_MODE_BREATH,
+    LAMP_MODE_STACK,
+    LAMP_MODE_FIXED,
+    LAMP_MODE_NOISE,
+    LAMP_MODE_FIRE,
+    LAMP_MODE_SPARKS,
+    LAMP_MODE_COMET,
+    LAMP_MODE_RAIN,
+    LAMP_MODE_BUTT
+} LAMP_MODE_ENUM;
+
+/**
+ * @brief Lamp parameters, written by the control task and read by the
+ *        renderer once per frame
+ *
+ */
+typedef struct {
+    uint32_t                   epoch;   /*!< bumped on every mode change */
+    uint8_t                lamp_mode;
+    uint8_t                    power;
+    uint16_t                     hue;
+    uint8_t               saturation;
+    uint8_t                    value;
+    uint8_t                     kick;   /*!< 7 bit count of vibration hits */
+} lamp_params_t;
+
+/**
+ * @brief Seqlock protected parameter block
+ *
+ * There must be a single writer. Readers never block the writer; they retry
+ * when the sequence was odd or changed while they were copying.
+ *
+ */
+typedef struct {
+    uint32_t                     seq;
+    lamp_params_t             params;
+} lamp_state_t;
+
+static inline void lamp_state_publish(lamp_state_t *state,
+                                      const lamp_params_t *params) {
+    uint32_t seq = __atomic_load_n(&state->seq, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&state->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&state->params, params, sizeof(lamp_params_t));
+    __atomic_store_n(&state->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+static inline void lamp_state_snapshot(const lamp_state_t *state,
+                                       lamp_params_t *params) {
+    uint32_t begin, end;
+
+    do {
+        begin = __atomic_load_n(&state->seq, __ATOMIC_ACQUIRE);
+        memcpy(params, &state->params, sizeof(lamp_params_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        end = __atomic_load_n(&state->seq, __ATOMIC_RELAXED);
+    } while ((begin & 1) || begin != end);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_STATE_H */
@@ -0,0 +1,152 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 20:15:52
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 20:15:55
+ * @FilePath    : /shellhome-nightlamp/main/lamp_sync.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <string.h>
+
+#include "lamp_sync.h"
+
+/* packets, little endian: 'L' 'S' version type node:u32, then
+ *   request:  seq:u32 t1:i64
+ *   response: to:u32 seq:u32 t1:i64 t2:i64 t3:i64 */
+#define SYNC_REQ            1
+#define SYNC_RESP           2
+#define SYNC_HDR_LEN        8
+#define SYNC_REQ_LEN        (SYNC_HDR_LEN + 12)
+#define SYNC_RESP_LEN       (SYNC_HDR_LEN + 32)
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = v >> (8 * i);
+    }
+}
+
+static void put_i64(uint8_t *p, int64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)((uint64_t)v >> 32));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int64_t get_i64(const uint8_t *p) {
+    return (int64_t)(get_u32(p) | ((uint64_t)get_u32(p + 4) << 32));
+}
+
+static void put_header(uint8_t *p, uint8_t type, uint32_t node) {
+    p[0] = 'L';
+    p[1] = 'S';
+    p[2] = LAMP_SYNC_VERSION;
+    p[3] = type;
+    put_u32(p + 4, node);
+}
+
+static void sync_send(lamp_sync_t *sync, const uint8_t *buf, size_t len) {
+    if (0 == sync->transport->send(sync->transport->ctx, buf, len)) {
+        sync->stats.sent++;
+    }
+}
+
+void lamp_sync_init(lamp_sync_t *sync, lamp_sync_role_t role, uint32_t node,
+                    const lamp_sync_transport_t *transport) {
+    memset(sync, 0, sizeof(lamp_sync_t));
+    sync->role = role;
+    sync->node = node;
+    sync->transport = transport;
+    // the master time is the time
+    sync->locked = LAMP_SYNC_MASTER == role;
+}
+
+void lamp_sync_poll(lamp_sync_t *sync) {
+    uint8_t pkt[SYNC_REQ_LEN];
+
+    if (LAMP_SYNC_SLAVE != sync->role) {
+        return;
+    }
+    // an unanswered request is simply superseded
+    sync->seq++;
+    sync->t1 = sync->transport->now(sync->transport->ctx);
+    put_header(pkt, SYNC_REQ, sync->node);
+    put_u32(pkt + 8, sync->seq);
+    put_i64(pkt + 12, sync->t1);
+    sync_send(sync, pkt, sizeof(pkt));
+}
+
+static void sync_answer(lamp_sync_t *sync, const uint8_t *req, int64_t t2) {
+    uint8_t pkt[SYNC_RESP_LEN];
+
+    put_header(pkt, SYNC_RESP, sync->node);
+    put_u32(pkt + 8, get_u32(req + 4));         // requester
+    put_u32(pkt + 12, get_u32(req + 8));        // seq
+    memcpy(pkt + 16, req + 12, 8);              // t1 echoed
+    put_i64(pkt + 24, t2);
+    // stamped last, the slave removes our dwell from the round trip
+    put_i64(pkt + 32, sync->transport->now(sync->transport->ctx));
+    sync_send(sync, pkt, sizeof(pkt));
+    sync->stats.answered++;
+}
+
+/**< fold a sample in, the fastest round trip of the window is the least skewed */
+static bool sync_sample(lamp_sync_t *sync, int64_t offset_us, uint32_t delay_us) {
+    sync->window[sync->next] = (lamp_sync_sample_t){offset_us, delay_us};
+    sync->next = (sync->next + 1) % LAMP_SYNC_WINDOW;
+    sync->samples += sync->samples < LAMP_SYNC_WINDOW;
+
+    const lamp_sync_sample_t *best = &sync->window[0];
+    for (uint8_t i = 1; i < sync->samples; i++) {
+        if (sync->window[i].delay_us < best->delay_us) {
+            best = &sync->window[i];
+        }
+    }
+
+    int64_t error = best->offset_us - sync->offset_us;
+    if (!sync->locked || error > LAMP_SYNC_STEP_US || error < -LAMP_SYNC_STEP_US) {
+        sync->offset_us = best->offset_us;
+        sync->locked = 1;
+        sync->stats.steps++;
+    } else {
+        // slew a quarter per sample so the shared time barely jumps back
+        sync->offset_us += error / 4;
+    }
+    return true;
+}
+
+bool lamp_sync_input(lamp_sync_t *sync, const uint8_t *buf, size_t len, int64_t local_us) {
+    if (len < SYNC_HDR_LEN || 'L' != buf[0] || 'S' != buf[1] || LAMP_SYNC_VERSION != buf[2]) {
+        sync->stats.dropped++;
+        return false;
+    }
+    if (get_u32(buf + 4) == sync->node) {
+        // our own broadcast looped back
+        return false;
+    }
+    sync->stats.received++;
+
+    if (SYNC_REQ == buf[3] && SYNC_REQ_LEN == len && LAMP_SYNC_MASTER == sync->role) {
+        sync_answer(sync, buf, local_us);
+        return false;
+    }
+    if (SYNC_RESP == buf[3] && SYNC_RESP_LEN == len && LAMP_SYNC_SLAVE == sync->role
+        && get_u32(buf + 8) == sync->node && get_u32(buf + 12) == sync->seq
+        && get_i64(buf + 16) == sync->t1) {
+        int64_t t1 = sync->t1;
+        int64_t t2 = get_i64(buf + 24);
+        int64_t t3 = get_i64(buf + 32);
+        int64_t delay = (local_us - t1) - (t3 - t2);
+        // one sample per request, duplicates and replays fall through
+        sync->seq++;
+        if (delay >= 0 && delay <= UINT32_MAX) {
+            sync->stats.samples++;
+            return sync_sample(sync, ((t2 - t1) + (t3 - local_us)) / 2, (uint32_t)delay);
+        }
+    }
+    sync->stats.dropped++;
+    return false;
+}
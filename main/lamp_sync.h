@@ -0,0 +1,98 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 20:15:31
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 20:15:34
+ * @FilePath    : /shellhome-nightlamp/main/lamp_sync.h
+ * @Description : clock offset protocol between lamps over a pluggable
+ *                transport, no ESP-IDF dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_SYNC_H
+#define LAMP_SYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define LAMP_SYNC_VERSION   1
+#define LAMP_SYNC_WINDOW    8           /**< samples kept, the fastest round trip wins */
+#define LAMP_SYNC_STEP_US   20000       /**< larger errors step, smaller ones slew */
+#define LAMP_SYNC_PKT_MAX   40
+
+/**
+ * @brief Transport, broadcasts one packet to every lamp; received packets
+ *        are fed to lamp_sync_input() with the local receive time
+ *
+ */
+typedef struct {
+    int            (*send)(void *ctx, const uint8_t *buf, size_t len);
+    int64_t         (*now)(void *ctx);  /*!< local time in us */
+    void                        *ctx;
+} lamp_sync_transport_t;
+
+typedef enum {
+    LAMP_SYNC_MASTER,                   /*!< owns the time, answers requests */
+    LAMP_SYNC_SLAVE,                    /*!< follows the master */
+} lamp_sync_role_t;
+
+typedef struct {
+    int64_t                offset_us;   /*!< master time - local time */
+    uint32_t                delay_us;   /*!< round trip without master dwell */
+} lamp_sync_sample_t;
+
+typedef struct {
+    uint32_t                    sent;
+    uint32_t                received;
+    uint32_t                answered;   /*!< requests answered as master */
+    uint32_t                 samples;   /*!< responses to our requests */
+    uint32_t                 dropped;   /*!< malformed, stale or not for us */
+    uint32_t                   steps;   /*!< offset jumps instead of slews */
+} lamp_sync_stats_t;
+
+typedef struct {
+    lamp_sync_role_t            role;
+    uint32_t                    node;   /*!< unique per lamp */
+    const lamp_sync_transport_t *transport;
+    uint32_t                     seq;   /*!< of the outstanding request */
+    int64_t                       t1;   /*!< local send time of that request */
+    lamp_sync_sample_t window[LAMP_SYNC_WINDOW];
+    uint8_t                  samples;
+    uint8_t                     next;
+    uint8_t                   locked;
+    int64_t                offset_us;   /*!< applied offset */
+    lamp_sync_stats_t          stats;
+} lamp_sync_t;
+
+// init a master or slave
+void lamp_sync_init(lamp_sync_t *sync, lamp_sync_role_t role, uint32_t node,
+                    const lamp_sync_transport_t *transport);
+
+// slave: send the next request, call once per sync period
+void lamp_sync_poll(lamp_sync_t *sync);
+
+/**
+ * @brief Handle one received packet
+ *
+ * @param local_us: local time the packet arrived, taken as early as possible
+ *
+ * @return true when the offset was updated
+ */
+bool lamp_sync_input(lamp_sync_t *sync, const uint8_t *buf, size_t len, int64_t local_us);
+
+// shared time for a local time, the local time itself until locked
+static inline int64_t lamp_sync_time_us(const lamp_sync_t *sync, int64_t local_us) {
+    return local_us + sync->offset_us;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_SYNC_H */
@@ -0,0 +1,134 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-19 14:07:02
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-19 14:07:05
+ * @FilePath    : /shellhome-nightlamp/main/lamp_tier.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <string.h>
+
+#include "lamp_tier.h"
+
+/**< cell voltage in mV at 0%, 10% ... 100%, a Li-ion discharge at light load */
+static const uint16_t g_soc_mv[] = {
+    3300, 3600, 3680, 3740, 3780, 3820, 3870, 3930, 4000, 4080, 4180,
+};
+#define SOC_POINTS  (sizeof(g_soc_mv) / sizeof(g_soc_mv[0]))
+
+static const lamp_tier_policy_t g_policy[LAMP_TIER_BUTT] = {
+    /* soc_below  value_max  frame_ms  fallback           fallback_all */
+    {  100,       100,         0,      LAMP_MODE_BUTT,    0 },
+    {   40,        70,        33,      LAMP_MODE_BUTT,    0 },
+    {   20,        45,        50,      LAMP_MODE_BREATH,  0 },
+    {    8,        25,       100,      LAMP_MODE_FIXED,   1 },
+};
+
+static const char *g_names[LAMP_TIER_BUTT] = {
+    "full", "save", "low", "critical",
+};
+
+/**< effects running a simulation on every frame */
+static bool is_costly_mode(uint8_t mode) {
+    return LAMP_MODE_NOISE == mode || LAMP_MODE_FIRE == mode ||
+           LAMP_MODE_SPARKS == mode || LAMP_MODE_COMET == mode ||
+           LAMP_MODE_RAIN == mode;
+}
+
+void lamp_tier_init(lamp_tier_t *tier, uint32_t dwell_ms) {
+    memset(tier, 0, sizeof(lamp_tier_t));
+    tier->dwell_ms = dwell_ms;
+}
+
+uint8_t lamp_tier_soc(int32_t mv) {
+    if (mv <= g_soc_mv[0]) {
+        return 0;
+    }
+    for (uint32_t i = 1; i < SOC_POINTS; i++) {
+        if (mv < g_soc_mv[i]) {
+            // linear within the 10% step
+            return (i - 1) * 10 + (mv - g_soc_mv[i - 1]) * 10 / (g_soc_mv[i] - g_soc_mv[i - 1]);
+        }
+    }
+    return 100;
+}
+
+/**< level the charge points to, seen from the current one */
+static uint8_t tier_target(uint8_t level, uint8_t soc) {
+    // down as far as the charge goes
+    while (level + 1 < LAMP_TIER_BUTT && soc < g_policy[level + 1].soc_below) {
+        level++;
+    }
+    // up only once clear of the hysteresis
+    while (level > LAMP_TIER_FULL && soc >= g_policy[level].soc_below + LAMP_TIER_HYST) {
+        level--;
+    }
+    return level;
+}
+
+bool lamp_tier_update(lamp_tier_t *tier, int32_t mv, bool external, uint32_t now_ms) {
+    if (tier->started) {
+        tier->time_ms[tier->level] += now_ms - tier->last_ms;
+    }
+    tier->last_ms = now_ms;
+    if (mv <= 0) {
+        return false;
+    }
+
+    tier->soc = lamp_tier_soc(mv);
+    uint8_t target = external ? LAMP_TIER_FULL : tier_target(tier->level, tier->soc);
+    if (target == tier->level) {
+        tier->pending = target;
+        tier->started = 1;
+        return false;
+    }
+    if (tier->started && !external) {
+        if (target != tier->pending) {
+            tier->pending = target;
+            tier->pending_ms = now_ms;
+            return false;
+        }
+        if (now_ms - tier->pending_ms < tier->dwell_ms) {
+            return false;
+        }
+    }
+
+    // the first sample and the charger take effect at once
+    tier->started = 1;
+    tier->level = target;
+    tier->pending = target;
+    tier->changes++;
+    return true;
+}
+
+const lamp_tier_policy_t *lamp_tier_policy(uint8_t level) {
+    return &g_policy[level < LAMP_TIER_BUTT ? level : LAMP_TIER_FULL];
+}
+
+void lamp_tier_params(uint8_t level, lamp_params_t *params) {
+    const lamp_tier_policy_t *policy = lamp_tier_policy(level);
+
+    params->value = params->value > policy->value_max ? policy->value_max : params->value;
+    if (LAMP_MODE_BUTT == policy->fallback || policy->fallback == params->lamp_mode ||
+        (!policy->fallback_all && !is_costly_mode(params->lamp_mode))) {
+        return;
+    }
+    params->lamp_mode = policy->fallback;
+    // one epoch per level, a fallback starts fresh and so does the way back
+    params->epoch ^= (uint32_t)level << 6;
+}
+
+uint32_t lamp_tier_interval(uint8_t level, uint32_t interval) {
+    const lamp_tier_policy_t *policy = lamp_tier_policy(level);
+
+    if (LAMP_RENDER_IDLE == interval || interval >= policy->frame_ms) {
+        return interval;
+    }
+    return policy->frame_ms;
+}
+
+const char *lamp_tier_name(uint8_t level) {
+    return level < LAMP_TIER_BUTT ? g_names[level] : "?";
+}
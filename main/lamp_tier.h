@@ -0,0 +1,102 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-19 14:06:33
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-19 14:06:36
+ * @FilePath    : /shellhome-nightlamp/main/lamp_tier.h
+ * @Description : quality tiers following the battery charge, no ESP-IDF
+ *                dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_TIER_H
+#define LAMP_TIER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lamp_state.h"
+#include "lamp_render.h"
+
+/*
+ * Every tier caps the value, stretches the frame interval and may show a
+ * cheaper mode instead of the chosen one. A tier is entered when the charge
+ * drops below its threshold and left when it is LAMP_TIER_HYST above it
+ * again. Both ways the charge must hold for the dwell time, so the sag under
+ * a bright frame or the rebound after dimming doesn't flip the tier.
+ * External power goes back to LAMP_TIER_FULL at once.
+ */
+typedef enum {
+    LAMP_TIER_FULL,
+    LAMP_TIER_SAVE,
+    LAMP_TIER_LOW,
+    LAMP_TIER_CRITICAL,
+    LAMP_TIER_BUTT
+} lamp_tier_level_t;
+
+/**< charge in % to climb above the threshold of a tier to leave it */
+#define LAMP_TIER_HYST      5
+
+typedef struct {
+    uint8_t                soc_below;   /*!< entered below this charge in % */
+    uint8_t                value_max;   /*!< cap of the value */
+    uint16_t                frame_ms;   /*!< shortest frame interval */
+    uint8_t                 fallback;   /*!< mode shown instead, LAMP_MODE_BUTT for none */
+    uint8_t             fallback_all;   /*!< replace every mode, not only the costly ones */
+} lamp_tier_policy_t;
+
+typedef struct {
+    uint32_t                dwell_ms;
+    uint8_t                    level;   /*!< lamp_tier_level_t */
+    uint8_t                  pending;   /*!< level the charge points to */
+    uint8_t                      soc;   /*!< last estimate in % */
+    uint8_t                  started;
+    uint32_t              pending_ms;   /*!< since when it points there */
+    uint32_t                 last_ms;
+    uint32_t                 changes;
+    uint64_t   time_ms[LAMP_TIER_BUTT]; /*!< spent in each tier */
+} lamp_tier_t;
+
+// init at LAMP_TIER_FULL, a tier change waits dwell_ms
+void lamp_tier_init(lamp_tier_t *tier, uint32_t dwell_ms);
+
+// charge in % of a cell at this voltage
+uint8_t lamp_tier_soc(int32_t mv);
+
+/**
+ * @brief Feed a battery sample
+ *
+ * @param mv: cell voltage, 0 or less when there is no sample yet
+ * @param external: charging or charged, the lamp runs from the charger
+ *
+ * @return true when the tier changed
+ */
+bool lamp_tier_update(lamp_tier_t *tier, int32_t mv, bool external, uint32_t now_ms);
+
+// policy of a level
+const lamp_tier_policy_t *lamp_tier_policy(uint8_t level);
+
+/**
+ * @brief Params to render at a level, LAMP_TIER_FULL leaves them as they are
+ *
+ * A replaced mode also moves the epoch, so the renderer starts the effect
+ * shown and crossfades to it like to any other mode.
+ */
+void lamp_tier_params(uint8_t level, lamp_params_t *params);
+
+// frame interval stretched to the level, LAMP_RENDER_IDLE stays
+uint32_t lamp_tier_interval(uint8_t level, uint32_t interval);
+
+// name of a level for logs
+const char *lamp_tier_name(uint8_t level);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_TIER_H */
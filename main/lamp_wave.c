@@ -0,0 +1,40 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-19 16:12:35
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-19 16:12:38
+ * @FilePath    : /shellhome-nightlamp/main/lamp_wave.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include "lamp_wave.h"
+#include "lamp_wave_lut.h"      /**< generated by tools/wave_lut.py */
+
+#define LUT_SHIFT   (32 - LAMP_WAVE_LUT_BITS)
+#define FRAC_SHIFT  (LUT_SHIFT - 8)
+
+_Static_assert(LAMP_WAVE_LUT_NUM == LAMP_WAVE_TRIANGLE, "tables out of step with lamp_wave_shape_t");
+
+void lamp_wave_init(lamp_wave_t *wave, uint8_t shape, uint32_t period_ms) {
+    wave->step = LAMP_WAVE_STEP(period_ms ? period_ms : 1);
+    wave->shape = shape < LAMP_WAVE_BUTT ? shape : LAMP_WAVE_SINE;
+}
+
+uint16_t lamp_wave_sample(uint8_t shape, uint32_t phase) {
+    switch (shape) {
+        case LAMP_WAVE_TRIANGLE:
+            // up to the top at half the period, then back
+            return (phase < 0x80000000u ? phase : ~phase) >> 15;
+
+        case LAMP_WAVE_SAW:
+            return phase >> 16;
+
+        default: {
+            const uint16_t *lut = lamp_wave_lut[shape < LAMP_WAVE_LUT_NUM ? shape : LAMP_WAVE_SINE];
+            uint32_t i = phase >> LUT_SHIFT;
+            int32_t frac = (phase >> FRAC_SHIFT) & 0xff;
+            return lut[i] + (((int32_t)lut[i + 1] - lut[i]) * frac >> 8);
+        }
+    }
+}
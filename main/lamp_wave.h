@@ -0,0 +1,81 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-19 16:12:09
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-19 16:12:12
+ * @FilePath    : /shellhome-nightlamp/main/lamp_wave.h
+ * @Description : periodic waveforms from tables and a phase accumulator,
+ *                no ESP-IDF dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_WAVE_H
+#define LAMP_WAVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+
+/*
+ * A period is the full 32 bit phase. The phase of a frame is now_ms times
+ * the step of the wave, so lamps sharing a clock stay in step at any frame
+ * rate and the wrap of the phase is the end of a period. Every shape starts
+ * at its bottom and peaks at half the period, the first half of a round
+ * trip is a one way easing.
+ */
+typedef enum {
+    LAMP_WAVE_SINE,             /*!< raised cosine */
+    LAMP_WAVE_EASE,             /*!< cubic ease in and out, up and down */
+    LAMP_WAVE_EXP,              /*!< exp of a cosine, a long rest and a quick swell */
+    LAMP_WAVE_TRIANGLE,
+    LAMP_WAVE_SAW,              /*!< up over the whole period, then drops */
+    LAMP_WAVE_BUTT
+} lamp_wave_shape_t;
+
+/**< top of a sample, the bottom is 0 */
+#define LAMP_WAVE_TOP   0xffff
+
+/**< phase per ms for a period, for constant waves */
+#define LAMP_WAVE_STEP(period_ms)   ((uint32_t)((1ULL << 32) / (period_ms)))
+#define LAMP_WAVE_INIT(shape, period_ms)    { LAMP_WAVE_STEP(period_ms), (shape) }
+
+typedef struct {
+    uint32_t                    step;   /*!< phase per ms, 2^32 is one period */
+    uint8_t                    shape;   /*!< lamp_wave_shape_t */
+} lamp_wave_t;
+
+// set a wave of a shape and period, the period at least 1 ms
+void lamp_wave_init(lamp_wave_t *wave, uint8_t shape, uint32_t period_ms);
+
+// sample of a shape at a phase in [0, LAMP_WAVE_TOP], interpolated between entries
+uint16_t lamp_wave_sample(uint8_t shape, uint32_t phase);
+
+// phase of a wave at a time
+static inline uint32_t lamp_wave_phase(const lamp_wave_t *wave, uint32_t now_ms) {
+    return now_ms * wave->step;
+}
+
+/**
+ * @brief Sample a wave at a time
+ *
+ * @param offset: phase added, 2^32 / n shifts by an n-th of the period, for
+ *                pixels along a strip or lamps out of step on purpose
+ */
+static inline uint16_t lamp_wave_at(const lamp_wave_t *wave, uint32_t now_ms, uint32_t offset) {
+    return lamp_wave_sample(wave->shape, lamp_wave_phase(wave, now_ms) + offset);
+}
+
+// map a sample onto [lo, hi], hi may be below lo to swing the other way,
+// spans up to 32767
+static inline int32_t lamp_wave_scale(uint16_t sample, int32_t lo, int32_t hi) {
+    return lo + (((hi - lo) * (int32_t)sample + (1 << 15)) >> 16);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_WAVE_H */
@@ -0,0 +1,52 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 22:41:30
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 22:41:33
+ * @FilePath    : /shellhome-nightlamp/main/lamp_wire.c
+ * @Description :
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#include <math.h>
+
+#include "lamp_wire.h"
+#include "lamp_layout.h"
+
+void lamp_wire_init(lamp_wire_t *wire, uint32_t bit0, uint32_t bit1, uint8_t brightness) {
+    wire->bit0 = bit0;
+    wire->bit1 = bit1;
+    // frames hold sRGB, the LEDs take linear duty; the only pow() is here
+    for (int v = 0; v < 256; v++) {
+        float c = v / 255.0f;
+        float linear = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+        uint32_t out = (uint32_t)(linear * brightness + 0.5f);
+        // dim colors keep a glimmer instead of going out
+        wire->table[v] = 0 == out && v && brightness ? 1 : out;
+    }
+}
+
+void lamp_wire_encode(const lamp_wire_t *wire, const lamp_rgb_t *rgb, const uint16_t *logical,
+                      uint16_t first, uint16_t num, uint32_t *symbols) {
+    const uint32_t bit0 = wire->bit0;
+    const uint32_t bit1 = wire->bit1;
+
+    for (uint16_t p = first; p < first + num; p++) {
+        uint16_t l = NULL == logical ? p : logical[p];
+        uint32_t grb = 0;
+        if (LAMP_LAYOUT_NONE != l) {
+            const lamp_rgb_t *c = &rgb[l];
+            grb = (uint32_t)wire->table[c->g] << 16 | wire->table[c->r] << 8 | wire->table[c->b];
+        }
+        // most significant bit first, shifted out of the top of the word
+        grb <<= 8;
+        for (int k = 0; k < LAMP_WIRE_LED_SYMBOLS; k += 4) {
+            symbols[0] = (grb & 0x80000000u) ? bit1 : bit0;
+            symbols[1] = (grb & 0x40000000u) ? bit1 : bit0;
+            symbols[2] = (grb & 0x20000000u) ? bit1 : bit0;
+            symbols[3] = (grb & 0x10000000u) ? bit1 : bit0;
+            symbols += 4;
+            grb <<= 4;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/***
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 22:41:08
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 22:41:11
+ * @FilePath    : /shellhome-nightlamp/main/lamp_wire.h
+ * @Description : lamp frames straight to WS2812 bit symbols, with gamma and
+ *                brightness on the way, no ESP-IDF dependency
+ * @Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ */
+
+#ifndef LAMP_WIRE_H
+#define LAMP_WIRE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "lamp_frame.h"
+
+#define LAMP_WIRE_LED_SYMBOLS   24      /**< one symbol per bit, green first */
+
+/**
+ * @brief Symbols and the output curve of one strip
+ *
+ */
+typedef struct {
+    uint32_t                    bit0;   /*!< symbol word of a 0 bit */
+    uint32_t                    bit1;   /*!< symbol word of a 1 bit */
+    uint8_t               table[256];   /*!< sRGB to linear drive, times brightness */
+} lamp_wire_t;
+
+// set the symbols and build the table for brightness 0..255
+void lamp_wire_init(lamp_wire_t *wire, uint32_t bit0, uint32_t bit1, uint8_t brightness);
+
+/**
+ * @brief Emit the symbols of num physical LEDs from first on
+ *
+ * @param logical: logical LED of every physical one, LAMP_LAYOUT_NONE for
+ *                 a dark one, NULL when in order
+ * @param symbols: room for num * LAMP_WIRE_LED_SYMBOLS
+ */
+void lamp_wire_encode(const lamp_wire_t *wire, const lamp_rgb_t *rgb, const uint16_t *logical,
+                      uint16_t first, uint16_t num, uint32_t *symbols);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* LAMP_WIRE_H */
@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+@Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+@Date        : 2026-10-18 21:24:16
+@LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+@LastEditTime: 2026-10-18 21:24:19
+@FilePath    : /shellhome-nightlamp/tools/anim_encode.py
+@Description : encode LED animations for the lamp_anim decoder
+Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+
+Usage:
+    tools/anim_encode.py --raw show.rgb --leds 47 --fps 60 -o show.lan
+    tools/anim_encode.py --demo --leds 47 -o demo.lan
+    tools/anim_encode.py --demo --leds 300 --header g_demo -o demo.h
+
+The raw input is frame after frame of leds RGB triplets. Every output is
+decoded again and compared with the input before it is written. The stream
+format is described in main/lamp_anim.h.
+"""
+
+import argparse
+import colorsys
+import random
+import struct
+import sys
+from collections import Counter
+
+VERSION = 1
+FLAG_PAL256 = 1
+KEY, DELTA = 0, 1
+OP_SKIP, OP_PAL, OP_COLOR, OP_RAW = 0, 1, 2, 3
+RUN_MAX = 64
+PAL_MAX = 256
+
+
+def pick_palette(frames):
+    """The most frequent colors, worth an index when repeated"""
+    count = Counter(c for f in frames for c in f)
+    return [c for c, n in count.most_common(PAL_MAX) if n > 1]
+
+
+def run_length(frame, at, limit):
+    end = at + 1
+    while end < limit and end - at < RUN_MAX and frame[end] == frame[at]:
+        end += 1
+    return end - at
+
+
+def encode_frame(frame, prev, index):
+    """Greedy ops over one frame, prev is None for a key frame"""
+    out = bytearray([KEY if prev is None else DELTA])
+    num = len(frame)
+    at = 0
+    while at < num:
+        if prev is not None and frame[at] == prev[at]:
+            n = 1
+            while at + n < num and n < RUN_MAX and frame[at + n] == prev[at + n]:
+                n += 1
+            out.append(OP_SKIP << 6 | (n - 1))
+            at += n
+            continue
+
+        n = run_length(frame, at, num)
+        color = frame[at]
+        if color in index:
+            out += bytes([OP_PAL << 6 | (n - 1), index[color]])
+            at += n
+        elif n > 1:
+            out += bytes([OP_COLOR << 6 | (n - 1), *color])
+            at += n
+        else:
+            # a literal stops where a cheaper op would start
+            raw = [color]
+            at += 1
+            while at < num and len(raw) < RUN_MAX:
+                c = frame[at]
+                if (prev is not None and c == prev[at]) or c in index \
+                        or run_length(frame, at, num) > 1:
+                    break
+                raw.append(c)
+                at += 1
+            out.append(OP_RAW << 6 | (len(raw) - 1))
+            for c in raw:
+                out += bytes(c)
+    return out
+
+
+def encode(frames, leds, frame_ms, key_every):
+    palette = pick_palette(frames)
+    index = {c: i for i, c in enumerate(palette)}
+    flags = FLAG_PAL256 if len(palette) == PAL_MAX else 0
+    out = bytearray(b"LANM")
+    out += struct.pack("<BBHHIH", VERSION, len(palette) & 0xff, leds, frame_ms,
+                       len(frames), flags)
+    for c in palette:
+        out += bytes(c)
+
+    prev = None
+    for i, frame in enumerate(frames):
+        key = encode_frame(frame, None, index)
+        if prev is not None and (key_every <= 0 or i % key_every):
+            delta = encode_frame(frame, prev, index)
+            key = delta if len(delta) < len(key) else key
+        out += key
+        prev = frame
+    return bytes(out)
+
+
+def decode(data):
+    """Reference decoder, mirrors lamp_anim_next()"""
+    assert data[:4] == b"LANM" and data[4] == VERSION
+    pal_num, leds, frame_ms, count, flags = struct.unpack_from("<BHHIH", data, 5)
+    pal_num = PAL_MAX if flags & FLAG_PAL256 else pal_num
+    pos = 16
+    palette = [tuple(data[pos + 3 * i:pos + 3 * i + 3]) for i in range(pal_num)]
+    pos += 3 * pal_num
+
+    frame = [(0, 0, 0)] * leds
+    frames = []
+    for _ in range(count):
+        kind = data[pos]
+        pos += 1
+        at = 0
+        while at < leds:
+            op, n = data[pos] >> 6, (data[pos] & 0x3f) + 1
+            pos += 1
+            if op == OP_SKIP:
+                assert kind == DELTA
+            elif op == OP_PAL:
+                frame[at:at + n] = [palette[data[pos]]] * n
+                pos += 1
+            elif op == OP_COLOR:
+                frame[at:at + n] = [tuple(data[pos:pos + 3])] * n
+                pos += 3
+            else:
+                frame[at:at + n] = [tuple(data[pos + 3 * i:pos + 3 * i + 3]) for i in range(n)]
+                pos += 3 * n
+            at += n
+        frames.append(list(frame))
+    assert pos == len(data)
+    return frames
+
+
+def read_raw(path, leds):
+    with open(path, "rb") as f:
+        data = f.read()
+    size = leds * 3
+    if len(data) % size:
+        sys.exit(f"{path}: {len(data)} bytes is not a whole number of {leds} LED frames")
+    return [[tuple(data[o + 3 * i:o + 3 * i + 3]) for i in range(leds)]
+            for o in range(0, len(data), size)]
+
+
+def demo(leds, fps):
+    """A second of a comet over a dim sky, one of a scrolling rainbow"""
+    rng = random.Random(7)
+    sky = (0, 0, 24)
+    frames = []
+    for t in range(fps):
+        frame = [sky] * leds
+        head = t * leds // fps
+        for k in range(8):
+            level = 255 >> k
+            frame[(head - k) % leds] = (level, level, level // 2)
+        if rng.random() < 0.3:
+            frame[rng.randrange(leds)] = (255, 255, 255)
+        frames.append(frame)
+    for t in range(fps):
+        frame = []
+        for i in range(leds):
+            r, g, b = colorsys.hsv_to_rgb(((i + 2 * t) % leds) / leds, 1.0, 1.0)
+            frame.append((round(r * 255), round(g * 255), round(b * 255)))
+        frames.append(frame)
+    return frames
+
+
+def write_header(out, name, data, leds):
+    with open(out, "w") as f:
+        f.write("/* generated by tools/anim_encode.py, do not edit */\n")
+        f.write("#pragma once\n\n#include <stdint.h>\n\n")
+        f.write(f"#define {name.upper()}_LEDS {leds}\n")
+        f.write(f"static const uint8_t {name}[{len(data)}] = {{\n")
+        for o in range(0, len(data), 16):
+            f.write("    " + ", ".join(f"0x{b:02x}" for b in data[o:o + 16]) + ",\n")
+        f.write("};\n")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    src = ap.add_mutually_exclusive_group(required=True)
+    src.add_argument("--raw", help="RGB frames, leds triplets each")
+    src.add_argument("--demo", action="store_true", help="built in test show")
+    ap.add_argument("--leds", type=int, required=True)
+    ap.add_argument("--fps", type=int, default=60)
+    ap.add_argument("--key", type=int, default=60, help="force a key frame every N frames, 0 never")
+    ap.add_argument("--header", metavar="NAME", help="write a C header with array NAME")
+    ap.add_argument("-o", "--output", required=True)
+    args = ap.parse_args()
+
+    if not 0 < args.leds < 65536 or not 0 < args.fps <= 1000:
+        sys.exit("leds or fps out of range")
+    frames = demo(args.leds, args.fps) if args.demo else read_raw(args.raw, args.leds)
+    data = encode(frames, args.leds, max(1, round(1000 / args.fps)), args.key)
+    if decode(data) != frames:
+        sys.exit("round trip failed")
+
+    if args.header:
+        write_header(args.output, args.header, data, args.leds)
+    else:
+        with open(args.output, "wb") as f:
+            f.write(data)
+    raw = len(frames) * args.leds * 3
+    print(f"{len(frames)} frames of {args.leds} LEDs: {raw} -> {len(data)} bytes, "
+          f"{raw / len(data):.1f}x", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,94 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-20 11:40:18
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-20 11:40:21
+ * @FilePath    : /shellhome-nightlamp/tools/gesture_test.c
+ * @Description : host checks of the gesture recognizer around the quiet
+ *                time that closes a sequence
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ *
+ * Exits non-zero on the first failed check:
+ *     cc -O2 -DLAMP_HOST_BUILD -Imain tools/gesture_test.c main/lamp_gesture.c -o gesture_test
+ *     ./gesture_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "lamp_gesture.h"
+
+#define TEST_DEBOUNCE_MS    50
+#define TEST_DOUBLE_MS      400
+
+static const lamp_gesture_config_t g_cfg = {
+    .debounce_ms = TEST_DEBOUNCE_MS,
+    .double_ms   = TEST_DOUBLE_MS,
+    .shake_ms    = 1000,
+    .shake_hits  = 6,
+};
+
+static int g_failed;
+
+static void expect(const char *what, lamp_gesture_t got, lamp_gesture_t want) {
+    if (got != want) {
+        printf("FAIL %s: %s, expected %s\n", what, lamp_gesture_name(got),
+               lamp_gesture_name(want));
+        g_failed++;
+    }
+}
+
+// two edges fed without a poll in between, as when the task is woken by the
+// second edge before its poll timeout
+static void feed_only(uint32_t gap_ms, lamp_gesture_t first, lamp_gesture_t second) {
+    lamp_gesture_rec_t rec;
+    char what[64];
+
+    lamp_gesture_init(&rec, &g_cfg);
+    snprintf(what, sizeof(what), "gap %"PRIu32" first edge", gap_ms);
+    expect(what, lamp_gesture_feed(&rec, 1000), LAMP_GESTURE_NONE);
+    snprintf(what, sizeof(what), "gap %"PRIu32" second edge", gap_ms);
+    expect(what, lamp_gesture_feed(&rec, 1000 + gap_ms), first);
+    snprintf(what, sizeof(what), "gap %"PRIu32" close", gap_ms);
+    expect(what, lamp_gesture_poll(&rec, 1000 + gap_ms + TEST_DOUBLE_MS), second);
+}
+
+static void on_gesture(lamp_gesture_t gesture, uint32_t at_ms, void *arg) {
+    lamp_gesture_t *seen = arg;
+
+    while (LAMP_GESTURE_NONE != *seen) {
+        seen++;
+    }
+    *seen = gesture;
+}
+
+int main(void) {
+    // just inside the quiet time the second edge makes a double tap
+    feed_only(TEST_DOUBLE_MS - 1, LAMP_GESTURE_NONE, LAMP_GESTURE_DOUBLE_TAP);
+    // at and past it the first tap is closed by the second edge
+    feed_only(TEST_DOUBLE_MS, LAMP_GESTURE_TAP, LAMP_GESTURE_TAP);
+    feed_only(TEST_DOUBLE_MS + 1, LAMP_GESTURE_TAP, LAMP_GESTURE_TAP);
+    feed_only(10 * TEST_DOUBLE_MS, LAMP_GESTURE_TAP, LAMP_GESTURE_TAP);
+
+    // a closed double tap followed by a late tap stays two gestures
+    lamp_gesture_rec_t rec;
+    lamp_gesture_init(&rec, &g_cfg);
+    lamp_gesture_feed(&rec, 0);
+    lamp_gesture_feed(&rec, 200);
+    expect("double then tap", lamp_gesture_feed(&rec, 200 + TEST_DOUBLE_MS),
+           LAMP_GESTURE_DOUBLE_TAP);
+    expect("double then tap close", lamp_gesture_poll(&rec, 200 + 2 * TEST_DOUBLE_MS),
+           LAMP_GESTURE_TAP);
+
+    // replay agrees on the same boundary
+    static const uint32_t edges[] = {0, TEST_DOUBLE_MS, 2 * TEST_DOUBLE_MS - 1};
+    lamp_gesture_t seen[4] = {LAMP_GESTURE_NONE};
+    lamp_gesture_replay(&g_cfg, edges, sizeof(edges) / sizeof(edges[0]), on_gesture, seen);
+    expect("replay first", seen[0], LAMP_GESTURE_TAP);
+    expect("replay second", seen[1], LAMP_GESTURE_DOUBLE_TAP);
+    expect("replay end", seen[2], LAMP_GESTURE_NONE);
+
+    printf("%s\n", g_failed ? "gesture checks failed" : "gesture checks passed");
+    return g_failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
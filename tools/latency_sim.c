@@ -0,0 +1,183 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 23:18:40
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 23:18:43
+ * @FilePath    : /shellhome-nightlamp/tools/latency_sim.c
+ * @Description : the lamp_latency probes on the host, over a simulated clock
+ *                that models the sensor tick, leds_task and the renderer
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ *
+ * Random buttons, gestures and hits run through the real control state
+ * machine and renderer; the histograms come out like the device prints
+ * them. The second argument is the settle delay of leds_task in ms. The
+ * effects need the generated tables, the firmware build makes them the same
+ * way:
+ *     mkdir -p build/host
+ *     python3 tools/oklch_lut.py build/host/lamp_color_lut.h
+ *     python3 tools/wave_lut.py build/host/lamp_wave_lut.h
+ *     cc -O2 -DLAMP_HOST_BUILD -Imain -Ibuild/host tools/latency_sim.c \
+ *        main/lamp_latency.c main/lamp_ctrl.c main/lamp_render.c main/lamp_effect.c \
+ *        main/lamp_fx.c main/lamp_particle.c main/lamp_layout.c main/lamp_color.c \
+ *        main/lamp_wave.c -lm -o latency_sim
+ *     ./latency_sim 600 1000
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "lamp_ctrl.h"
+#include "lamp_render.h"
+#include "lamp_latency.h"
+
+#define SIM_TICK_MS         20          /**< CONFIG_SENSOR_TICK_MS */
+#define SIM_DEBOUNCE        2           /**< CONFIG_SENSOR_BUTTON_DEBOUNCE */
+#define SIM_FADE_MS         500
+#define SIM_FADE_STEP_MS    20
+#define SIM_WIRE_US         (LAMP_STRIP_MAX * 30 + 280)
+
+/**< mean ms between inputs of each source */
+static const uint32_t g_mean_ms[LAMP_LATENCY_SOURCE_NUM] = {
+    [LAMP_LATENCY_BUTTON_1] = 7000,
+    [LAMP_LATENCY_BUTTON_2] = 11000,
+    [LAMP_LATENCY_GESTURE]  = 13000,
+    [LAMP_LATENCY_KICK]     = 900,
+};
+
+static lamp_latency_t g_lat;
+
+static uint32_t next_in(uint32_t now_ms, uint8_t source) {
+    return now_ms + 1 + (uint32_t)(rand() % (2 * g_mean_ms[source]));
+}
+
+static void print_hist(const lamp_latency_hist_t *hist, uint8_t source) {
+    printf("%-8s %6"PRIu32" samples", lamp_latency_source_name(source), hist->count);
+    if (hist->count) {
+        printf(", min %"PRIu32" avg %"PRIu32" max %"PRIu32" us, p50 < %"PRIu32" p99 < %"PRIu32" ms",
+               hist->min_us, (uint32_t)(hist->sum_us / hist->count), hist->max_us,
+               lamp_latency_percentile(hist, 50) / 1000, lamp_latency_percentile(hist, 99) / 1000);
+    }
+    printf(", %"PRIu32" dropped\n", hist->dropped);
+    for (uint32_t bin = 0; bin < LAMP_LATENCY_BINS; bin++) {
+        if (hist->bins[bin]) {
+            printf("    >= %6"PRIu32" ms %6"PRIu32"\n", lamp_latency_bin_us(bin) / 1000,
+                   hist->bins[bin]);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t seconds = argc > 1 ? (uint32_t)atoi(argv[1]) : 600;
+    uint32_t settle_ms = argc > 2 ? (uint32_t)atoi(argv[2]) : 1000;
+    static lamp_render_t render;
+    lamp_render_config_t cfg = {
+        .fade_ms = SIM_FADE_MS,
+        .step_ms = SIM_FADE_STEP_MS,
+    };
+    lamp_params_t params = {
+        .lamp_mode = LAMP_MODE_SPARKS,
+        .power = 1,
+        .hue = 120,
+        .saturation = 80,
+        .value = 100,
+    };
+    lamp_state_t state = {0};
+    uint32_t due_ms[LAMP_LATENCY_SOURCE_NUM];
+    int64_t edge_us[LAMP_LATENCY_SOURCE_NUM] = {0};
+    uint32_t pending = 0;           /*!< event bits, one per control type */
+    uint32_t busy_ms = 0;           /*!< leds_task settles until then */
+    uint32_t frame_ms = 0;          /*!< renderer sleeps until then */
+    bool woken = false;
+
+    srand(7);
+    lamp_render_init(&render, &cfg);
+    lamp_latency_init(&g_lat);
+    lamp_state_publish(&state, &params);
+    for (uint8_t i = 0; i < LAMP_LATENCY_SOURCE_NUM; i++) {
+        due_ms[i] = next_in(0, i);
+    }
+
+    for (uint32_t now = 0; now < seconds * 1000; now++) {
+        int64_t now_us = now * 1000LL;
+
+        // button tick: started by the interrupt of the edge, which is the
+        // first sample, and reported once it held for the debounce samples
+        for (uint8_t i = LAMP_LATENCY_BUTTON_1; i <= LAMP_LATENCY_BUTTON_2; i++) {
+            if (now < due_ms[i] || 0 != (now - due_ms[i]) % SIM_TICK_MS) {
+                continue;
+            }
+            if (0 == edge_us[i]) {
+                edge_us[i] = now_us;
+            }
+            if (now_us - edge_us[i] >= (SIM_DEBOUNCE - 1) * SIM_TICK_MS * 1000) {
+                uint8_t type = LAMP_LATENCY_BUTTON_1 == i ? LAMP_CTRL_COLOR : LAMP_CTRL_TIMER;
+                lamp_latency_input(&g_lat, type, i, edge_us[i]);
+                pending |= 1 << type;
+                edge_us[i] = 0;
+                due_ms[i] = next_in(now, i);
+            }
+        }
+        // hits come by interrupt, no tick in between
+        if (now >= due_ms[LAMP_LATENCY_KICK]) {
+            lamp_latency_input(&g_lat, LAMP_CTRL_KICK, LAMP_LATENCY_KICK, now_us);
+            pending |= 1 << LAMP_CTRL_KICK;
+            due_ms[LAMP_LATENCY_KICK] = next_in(now, LAMP_LATENCY_KICK);
+        }
+        if (now >= due_ms[LAMP_LATENCY_GESTURE]) {
+            uint8_t type = (uint8_t)(rand() % (LAMP_CTRL_OFF + 1));
+            lamp_latency_input(&g_lat, type, LAMP_LATENCY_GESTURE, now_us);
+            pending |= 1 << type;
+            due_ms[LAMP_LATENCY_GESTURE] = next_in(now, LAMP_LATENCY_GESTURE);
+        }
+
+        // leds_task: kicks right away, then one event and the settle delay
+        if (pending & (1 << LAMP_CTRL_KICK)) {
+            lamp_ctrl_event_t event = {.type = LAMP_CTRL_KICK};
+            bool published = lamp_ctrl_apply(&params, &event) & LAMP_CTRL_ACT_PUBLISH;
+            if (published) {
+                lamp_state_publish(&state, &params);
+                woken = true;
+            }
+            lamp_latency_applied(&g_lat, LAMP_CTRL_KICK, published);
+            pending &= ~(1 << LAMP_CTRL_KICK);
+        }
+        if (pending && now >= busy_ms) {
+            lamp_ctrl_event_t event = {.hue = (uint16_t)(rand() % 360), .saturation = 80};
+            for (event.type = 0; !(pending & (1 << event.type)); event.type++) {
+            }
+            bool published = lamp_ctrl_apply(&params, &event) & LAMP_CTRL_ACT_PUBLISH;
+            if (published) {
+                lamp_state_publish(&state, &params);
+                woken = true;
+            }
+            lamp_latency_applied(&g_lat, event.type, published);
+            for (uint8_t type = event.type + 1; type < LAMP_CTRL_KICK; type++) {
+                if (pending & (1 << type)) {
+                    lamp_latency_applied(&g_lat, type, false);
+                }
+            }
+            pending = 0;
+            busy_ms = now + settle_ms;
+        }
+
+        // renderer: on time or woken, the frame latches after the wire time
+        if (woken || now >= frame_ms) {
+            uint32_t interval;
+            lamp_params_t snap;
+            uint32_t gen = lamp_latency_frame_begin(&g_lat);
+            lamp_state_snapshot(&state, &snap);
+            lamp_render_frame(&render, &snap, now, &interval);
+            lamp_latency_frame_commit(&g_lat, gen, now_us + SIM_WIRE_US);
+            frame_ms = LAMP_RENDER_IDLE == interval ? UINT32_MAX : now + (interval ? interval : 1);
+            woken = false;
+        }
+    }
+
+    printf("%"PRIu32" s simulated, %"PRIu32" ms settle delay, %d LEDs\n",
+           seconds, settle_ms, LAMP_STRIP_MAX);
+    for (uint8_t i = 0; i < LAMP_LATENCY_SOURCE_NUM; i++) {
+        print_hist(&g_lat.hist[i], i);
+    }
+    return 0;
+}
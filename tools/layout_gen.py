@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+@Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+@Date        : 2026-10-18 19:20:41
+@LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+@LastEditTime: 2026-10-18 19:20:44
+@FilePath    : /shellhome-nightlamp/tools/layout_gen.py
+@Description : build the LED layout blob read by lamp_layout_parse()
+Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+
+Usage:
+    tools/layout_gen.py --ring 47 -o layout             # one ring
+    tools/layout_gen.py --grid 8x6 -o layout            # serpentine panel
+    tools/layout_gen.py --json lamp.json -o layout      # anything else
+
+    writes layout.bin and layout.csv, then flash into the nvs partition:
+    $IDF_PATH/components/nvs_flash/nvs_partition_generator/nvs_partition_gen.py \\
+        generate layout.csv nvs.bin 0x6000
+    parttool.py write_partition --partition-name nvs --input nvs.bin
+
+The JSON holds "segments": [[start, count, reverse], ...] in logical order
+and optionally "coords": [[x, y], ...], one per logical LED.
+"""
+
+import argparse
+import json
+import math
+import struct
+import sys
+
+VERSION = 1
+SEG_MAX = 8
+HAS_COORDS = 1
+NAMESPACE = "ShellHome"
+KEY = "lamp-layout"
+
+
+def ring(num, radius=1000):
+    """One segment, LEDs evenly around a circle"""
+    coords = [(round(radius * math.cos(2 * math.pi * i / num)),
+               round(radius * math.sin(2 * math.pi * i / num)))
+              for i in range(num)]
+    return [(0, num, 0)], coords
+
+
+def grid(cols, rows, pitch=100):
+    """Serpentine panel, every other row wired backwards"""
+    segments = []
+    coords = []
+    for r in range(rows):
+        segments.append((r * cols, cols, r & 1))
+        for c in range(cols):
+            coords.append((c * pitch, r * pitch))
+    return segments, coords
+
+
+def pack(segments, coords):
+    num = sum(count for _, count, _ in segments)
+    if not 0 < len(segments) <= SEG_MAX:
+        sys.exit("1 to %d segments" % SEG_MAX)
+    if coords and len(coords) != num:
+        sys.exit("%d coordinates for %d LEDs" % (len(coords), num))
+
+    blob = struct.pack("<BBHBx", VERSION, HAS_COORDS if coords else 0,
+                       num, len(segments))
+    for start, count, reverse in segments:
+        blob += struct.pack("<HHBx", start, count, 1 if reverse else 0)
+    for x, y in coords or []:
+        blob += struct.pack("<hh", x, y)
+    return blob, num
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    shape = parser.add_mutually_exclusive_group(required=True)
+    shape.add_argument("--ring", type=int, metavar="NUM")
+    shape.add_argument("--grid", metavar="COLSxROWS")
+    shape.add_argument("--json", metavar="FILE")
+    parser.add_argument("-o", "--output", default="layout",
+                        help="output name without extension")
+    args = parser.parse_args()
+
+    if args.ring:
+        segments, coords = ring(args.ring)
+    elif args.grid:
+        cols, rows = (int(v) for v in args.grid.lower().split("x"))
+        segments, coords = grid(cols, rows)
+    else:
+        with open(args.json, encoding="utf-8") as f:
+            spec = json.load(f)
+        segments = [tuple(s) for s in spec["segments"]]
+        coords = [tuple(c) for c in spec.get("coords", [])]
+
+    blob, num = pack(segments, coords)
+    with open(args.output + ".bin", "wb") as f:
+        f.write(blob)
+    with open(args.output + ".csv", "w", encoding="utf-8") as f:
+        f.write("key,type,encoding,value\n")
+        f.write("%s,namespace,,\n" % NAMESPACE)
+        f.write("%s,file,binary,%s.bin\n" % (KEY, args.output))
+    print("%d LEDs in %d segments, %d bytes" % (num, len(segments), len(blob)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+@Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+@Date        : 2026-10-18 19:40:12
+@LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+@LastEditTime: 2026-10-18 19:40:15
+@FilePath    : /shellhome-nightlamp/tools/oklch_lut.py
+@Description : generate the fixed point OKLab tables of lamp_color.c
+Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+
+Run by main/CMakeLists.txt at build time, by hand for host builds:
+    tools/oklch_lut.py build/lamp_color_lut.h
+"""
+
+import math
+import sys
+
+Q = 12                  # OKLab and linear RGB in 4.12 fixed point
+ONE = 1 << Q
+L_REF = 0.75            # lightness of a full value, saturated color
+C_REF = 0.125           # chroma of a full saturation, in gamut at L_REF
+CUBE_BITS = 8           # cube and sRGB tables indexed by the top bits
+SIZE = 1 << CUBE_BITS
+CUBE_Q = 15             # l m s keep more bits, the RGB matrix cancels them
+
+# Bjorn Ottosson, A perceptual color space for image processing (2020)
+LAB_TO_LMS = [
+    [1.0,  0.3963377774,  0.2158037573],
+    [1.0, -0.1055613458, -0.0638541728],
+    [1.0, -0.0894841775, -1.2914855480],
+]
+LMS_TO_RGB = [
+    [ 4.0767416621, -3.3077115913,  0.2309699292],
+    [-1.2684380046,  2.6097574011, -0.3413193965],
+    [-0.0041960863, -0.7034186147,  1.7076147010],
+]
+
+
+def srgb_encode(x):
+    return 12.92 * x if x <= 0.0031308 else 1.055 * x ** (1 / 2.4) - 0.055
+
+
+def fixed(x):
+    return int(round(x * ONE))
+
+
+def rows(values, per_line, fmt):
+    out = []
+    for i in range(0, len(values), per_line):
+        out.append("    " + " ".join(fmt % v + "," for v in values[i:i + per_line]))
+    return "\n".join(out)
+
+
+def matrix(name, m):
+    body = ",\n".join("    {%s}" % ", ".join("%6d" % fixed(v) for v in row) for row in m)
+    return "static const int32_t %s[3][3] = {\n%s\n};\n" % (name, body)
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: oklch_lut.py OUTPUT")
+
+    hue = []
+    for deg in range(360):
+        h = math.radians(deg)
+        hue += [fixed(math.cos(h)), fixed(math.sin(h))]
+    # l' m' s' in [0, 1] to l m s, one extra entry for interpolation
+    cube = [int(round((i / SIZE) ** 3 * (1 << CUBE_Q))) for i in range(SIZE + 1)]
+    # linear to sRGB encoded, 8 bit like every other frame value
+    srgb = [int(round(255 * srgb_encode(i / SIZE))) for i in range(SIZE + 1)]
+
+    with open(sys.argv[1], "w", encoding="utf-8") as f:
+        f.write("/* generated by tools/oklch_lut.py, do not edit */\n\n")
+        f.write("#define LAMP_OK_Q          %d\n" % Q)
+        f.write("#define LAMP_OK_ONE        %d\n" % ONE)
+        f.write("#define LAMP_OK_L_REF      %d\n" % fixed(L_REF))
+        f.write("#define LAMP_OK_C_REF      %d\n" % fixed(C_REF))
+        f.write("#define LAMP_OK_CUBE_Q     %d\n" % CUBE_Q)
+        f.write("#define LAMP_OK_LUT_SHIFT  %d\n\n" % (Q - CUBE_BITS))
+        f.write(matrix("lamp_ok_lab2lms", LAB_TO_LMS))
+        f.write(matrix("lamp_ok_lms2rgb", LMS_TO_RGB))
+        f.write("\n/* cos, sin per degree */\n")
+        f.write("static const int16_t lamp_ok_hue[360][2] = {\n%s\n};\n"
+                % rows(["{%d, %d}" % (hue[2 * i], hue[2 * i + 1]) for i in range(360)],
+                       6, "%s"))
+        f.write("\nstatic const uint16_t lamp_ok_cube[%d] = {\n%s\n};\n"
+                % (SIZE + 1, rows(cube, 12, "%4d")))
+        f.write("\nstatic const uint8_t lamp_ok_srgb[%d] = {\n%s\n};\n"
+                % (SIZE + 1, rows(srgb, 16, "%3d")))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,195 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-20 10:12:44
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-20 10:12:47
+ * @FilePath    : /shellhome-nightlamp/tools/record_replay.c
+ * @Description : replay a record dump on the host and check every frame
+ *                against the checksum the lamp recorded
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ *
+ * Feed it the console log of a record dump (the lines from REC-CFG to
+ * "record dump end"); the last dump in the log is replayed. The REC-CFG line
+ * says what the build must match: the LED count, the color path and the
+ * kernels. Generate the tables once, then build with those settings:
+ *     mkdir -p build/host
+ *     python3 tools/oklch_lut.py build/host/lamp_color_lut.h
+ *     python3 tools/wave_lut.py build/host/lamp_wave_lut.h
+ *     cc -O2 -DLAMP_HOST_BUILD -DCONFIG_STRIP_LED_NUM=47 -DCONFIG_LAMP_RECORD_NUM=8192 \
+ *        -Imain -Ibuild/host tools/record_replay.c main/lamp_record.c main/lamp_tier.c \
+ *        main/lamp_ctrl.c main/lamp_render.c main/lamp_effect.c main/lamp_fx.c \
+ *        main/lamp_particle.c main/lamp_layout.c main/lamp_color.c main/lamp_wave.c \
+ *        -lm -o record_replay
+ *     ./record_replay console.log
+ * Add -DLAMP_HOST_HSV for "oklch 0" and -DLAMP_HOST_REF for "kernels ref".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "lamp_record.h"
+#include "lamp_layout.h"
+#include "lamp_fx.h"
+
+#define REPLAY_SHOW_MAX     8           /**< mismatching frames printed */
+
+#ifdef LAMP_HOST_HSV
+#define REPLAY_OKLCH        0
+#else
+#define REPLAY_OKLCH        1
+#endif
+
+typedef struct {
+    int                         leds;
+    int                        oklch;
+    char                  kernels[8];
+    lamp_render_config_t         cfg;
+    uint8_t    blob[LAMP_LAYOUT_BLOB_MAX];
+    size_t                  blob_len;
+    lamp_record_t           *records;
+    size_t                       num;
+    size_t                       cap;
+    int                       has_cfg;
+} replay_dump_t;
+
+static void dump_reset(replay_dump_t *dump) {
+    lamp_record_t *records = dump->records;
+    size_t cap = dump->cap;
+
+    memset(dump, 0, sizeof(replay_dump_t));
+    dump->records = records;
+    dump->cap = cap;
+}
+
+static int parse_layout(replay_dump_t *dump, const char *line) {
+    unsigned at = 0;
+    int used = 0;
+
+    if (1 != sscanf(line, "REC-LAYOUT %x %n", &at, &used) || 0 == used) {
+        return -1;
+    }
+    const char *hex = line + used;
+    while (at < sizeof(dump->blob)) {
+        unsigned byte;
+        if (1 != sscanf(hex, "%2x", &byte)) {
+            break;
+        }
+        dump->blob[at++] = byte;
+        hex += 2;
+    }
+    dump->blob_len = at > dump->blob_len ? at : dump->blob_len;
+    return 0;
+}
+
+static int parse_record(replay_dump_t *dump, const char *line) {
+    unsigned ts, type, a, b, c;
+
+    if (5 != sscanf(line, "REC %x %x %x %x %x", &ts, &type, &a, &b, &c)) {
+        return -1;
+    }
+    if (dump->num == dump->cap) {
+        size_t cap = dump->cap ? dump->cap * 2 : 1024;
+        lamp_record_t *records = realloc(dump->records, cap * sizeof(lamp_record_t));
+        if (NULL == records) {
+            return -1;
+        }
+        dump->records = records;
+        dump->cap = cap;
+    }
+    dump->records[dump->num++] = (lamp_record_t) {
+        .ts_ms = ts, .type = type, .a = a, .b = b, .c = c,
+    };
+    return 0;
+}
+
+static void dump_read(replay_dump_t *dump, FILE *fp) {
+    char line[512];
+    const char *p;
+
+    while (NULL != fgets(line, sizeof(line), fp)) {
+        // the tokens may follow whatever the console put in front of them
+        if (NULL != (p = strstr(line, "REC-CFG "))) {
+            dump_reset(dump);
+            unsigned fade, step;
+            if (5 == sscanf(p, "REC-CFG leds %d oklch %d kernels %7s fade %u step %u",
+                            &dump->leds, &dump->oklch, dump->kernels, &fade, &step)) {
+                dump->cfg.fade_ms = fade;
+                dump->cfg.step_ms = step;
+                dump->has_cfg = 1;
+            }
+        } else if (NULL != (p = strstr(line, "REC-LAYOUT "))) {
+            parse_layout(dump, p);
+        } else if (NULL != (p = strstr(line, "REC "))) {
+            parse_record(dump, p);
+        }
+    }
+}
+
+static void on_frame(uint32_t index, uint32_t ts_ms, const lamp_frame_t *frame,
+                     bool match, void *arg) {
+    uint32_t *shown = arg;
+
+    if (match || *shown >= REPLAY_SHOW_MAX) {
+        return;
+    }
+    (*shown)++;
+    printf("frame %"PRIu32" at %"PRIu32" ms differs, replayed %08"PRIx32"\n",
+           index, ts_ms, lamp_frame_checksum(frame));
+}
+
+int main(int argc, char *argv[]) {
+    static replay_dump_t dump;
+    FILE *fp = stdin;
+
+    if (argc > 1 && NULL == (fp = fopen(argv[1], "r"))) {
+        perror(argv[1]);
+        return 2;
+    }
+    dump_read(&dump, fp);
+    if (stdin != fp) {
+        fclose(fp);
+    }
+    if (!dump.has_cfg) {
+        fprintf(stderr, "no REC-CFG line, not a record dump\n");
+        return 2;
+    }
+
+    const char *kernels = lamp_fx_kernels()->name;
+    if (LAMP_STRIP_MAX != dump.leds || REPLAY_OKLCH != dump.oklch ||
+        0 != strcmp(kernels, dump.kernels)) {
+        fprintf(stderr, "built for leds %d oklch %d kernels %s, the dump needs "
+                "leds %d oklch %d kernels %s: rebuild with -DCONFIG_STRIP_LED_NUM=%d%s%s\n",
+                LAMP_STRIP_MAX, REPLAY_OKLCH, kernels, dump.leds, dump.oklch,
+                dump.kernels, dump.leds, dump.oklch ? "" : " -DLAMP_HOST_HSV",
+                0 == strcmp(dump.kernels, "ref") ? " -DLAMP_HOST_REF" : "");
+        return 2;
+    }
+
+    static lamp_layout_config_t layout;
+    if (dump.blob_len > 0) {
+        if (!lamp_layout_parse(dump.blob, dump.blob_len, &layout)) {
+            fprintf(stderr, "bad REC-LAYOUT blob, %zu bytes\n", dump.blob_len);
+            return 2;
+        }
+    } else {
+        // dumps from before the layout was recorded ran the default line
+        lamp_layout_default(&layout, LAMP_STRIP_MAX);
+    }
+    lamp_layout_build(&layout);
+
+    lamp_replay_result_t result;
+    uint32_t shown = 0;
+    uint32_t bad = lamp_replay_run(dump.records, dump.num, &dump.cfg, &result,
+                                   on_frame, &shown);
+    printf("%zu records, %"PRIu32" inputs, %"PRIu32" events, %"PRIu32" frames\n",
+           dump.num, result.inputs, result.events, result.frames);
+    printf("frame mismatches %"PRIu32, result.frame_mismatches);
+    if (result.frame_mismatches) {
+        printf(" (first at frame %"PRIu32")", result.first_mismatch);
+    }
+    printf(", state mismatches %"PRIu32"\n", result.state_mismatches);
+    free(dump.records);
+    return bad ? 1 : 0;
+}
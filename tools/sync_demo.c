@@ -0,0 +1,136 @@
+/*
+ * @Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @Date        : 2026-10-18 20:52:06
+ * @LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+ * @LastEditTime: 2026-10-18 20:52:09
+ * @FilePath    : /shellhome-nightlamp/tools/sync_demo.c
+ * @Description : lamp_sync over UDP multicast on the host, standing in for
+ *                ESP-NOW
+ * Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+ *
+ * Build and run one master and any number of followers, each follower with
+ * a made up clock offset in ms; they print how far their shared time is
+ * from the master's:
+ *     cc -O2 -DLAMP_HOST_BUILD -Imain tools/sync_demo.c main/lamp_sync.c -o sync_demo
+ *     ./sync_demo master &
+ *     ./sync_demo follower 123456
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "lamp_sync.h"
+
+#define DEMO_GROUP      "239.255.76.83"
+#define DEMO_PORT       7683
+#define DEMO_PERIOD_US  500000
+
+typedef struct {
+    int                           fd;
+    struct sockaddr_in         group;
+    int64_t                 fake_us;   /*!< added to the clock of a follower */
+} udp_ctx_t;
+
+static int64_t mono_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static int udp_send(void *ctx, const uint8_t *buf, size_t len) {
+    udp_ctx_t *udp = ctx;
+    return sendto(udp->fd, buf, len, 0, (struct sockaddr *)&udp->group,
+                  sizeof(udp->group)) == (ssize_t)len ? 0 : -1;
+}
+
+static int64_t udp_now(void *ctx) {
+    return mono_us() + ((udp_ctx_t *)ctx)->fake_us;
+}
+
+static int udp_open(udp_ctx_t *udp) {
+    int one = 1;
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(DEMO_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    struct ip_mreq mreq;
+
+    udp->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (udp->fd < 0) {
+        return -1;
+    }
+    setsockopt(udp->fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(udp->fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    if (bind(udp->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        return -1;
+    }
+    mreq.imr_multiaddr.s_addr = inet_addr(DEMO_GROUP);
+    mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+    if (setsockopt(udp->fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        return -1;
+    }
+    struct in_addr lo = {.s_addr = htonl(INADDR_LOOPBACK)};
+    setsockopt(udp->fd, IPPROTO_IP, IP_MULTICAST_IF, &lo, sizeof(lo));
+    setsockopt(udp->fd, IPPROTO_IP, IP_MULTICAST_LOOP, &one, sizeof(one));
+
+    udp->group.sin_family = AF_INET;
+    udp->group.sin_port = htons(DEMO_PORT);
+    udp->group.sin_addr.s_addr = inet_addr(DEMO_GROUP);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    udp_ctx_t udp = {0};
+    lamp_sync_t sync;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s master | follower OFFSET_MS [SECONDS]\n", argv[0]);
+        return 1;
+    }
+    bool master = 0 == strcmp(argv[1], "master");
+    udp.fake_us = master || argc < 3 ? 0 : atoll(argv[2]) * 1000;
+    int seconds = argc > 3 ? atoi(argv[3]) : 10;
+    if (udp_open(&udp) < 0) {
+        perror("udp");
+        return 1;
+    }
+
+    lamp_sync_transport_t transport = {.send = udp_send, .now = udp_now, .ctx = &udp};
+    srand(getpid());
+    lamp_sync_init(&sync, master ? LAMP_SYNC_MASTER : LAMP_SYNC_SLAVE,
+                   (uint32_t)rand(), &transport);
+
+    int64_t end_us = mono_us() + seconds * 1000000LL;
+    int64_t poll_us = 0;
+    while (master || mono_us() < end_us) {
+        int64_t now = mono_us();
+        if (now >= poll_us) {
+            lamp_sync_poll(&sync);
+            poll_us = now + DEMO_PERIOD_US;
+        }
+        struct pollfd pfd = {.fd = udp.fd, .events = POLLIN};
+        if (poll(&pfd, 1, (int)((poll_us - now) / 1000) + 1) <= 0) {
+            continue;
+        }
+        uint8_t buf[LAMP_SYNC_PKT_MAX + 1];
+        ssize_t len = recv(udp.fd, buf, sizeof(buf), 0);
+        int64_t local_us = udp_now(&udp);
+        if (len > 0 && lamp_sync_input(&sync, buf, len, local_us)) {
+            // the master clock is the plain monotonic one
+            int64_t error = lamp_sync_time_us(&sync, local_us) - mono_us();
+            printf("offset %10lld us, error %6lld us\n",
+                   (long long)sync.offset_us, (long long)error);
+        }
+    }
+    printf("sent %u samples %u steps %u dropped %u\n", sync.stats.sent,
+           sync.stats.samples, sync.stats.steps, sync.stats.dropped);
+    return 0;
+}
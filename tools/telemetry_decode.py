@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+@Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+@Date        : 2026-10-18 23:58:02
+@LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+@LastEditTime: 2026-10-18 23:58:05
+@FilePath    : /shellhome-nightlamp/tools/telemetry_decode.py
+@Description : decode the binary telemetry of board_telemetry.c into CSV
+Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+
+Usage:
+    tools/telemetry_decode.py --port /dev/ttyUSB0 > telemetry.csv
+    tools/telemetry_decode.py --port /dev/ttyUSB1 --baud 921600 > telemetry.csv
+    tools/telemetry_decode.py capture.bin > telemetry.csv
+
+Reading a port needs pyserial. Frames are delimited by zero bytes, so log
+lines sharing the console are skipped; bad frames and sequence gaps are
+counted on stderr. Record names and fields come from the telemetry_type_t
+enum in main/board_telemetry.h.
+"""
+
+import argparse
+import csv
+import os
+import re
+import struct
+import sys
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      "..", "main", "board_telemetry.h")
+VERSION = 1
+RECORD = struct.Struct("<IBBHII")
+
+ENUM_RE = re.compile(r"^\s*(TELEMETRY_\w+)\s*,?\s*(?:/\*!<\s*(.*?)\s*\*/)?\s*$")
+FIELD_RE = re.compile(r"(\w+):\s*(.+?)(?=,\s*\w+:|$)")
+
+
+def load_types(header):
+    """Read record names and field notes from the telemetry_type_t enum"""
+    types = {}
+    in_enum = False
+    with open(header, encoding="utf-8") as f:
+        for line in f:
+            if line.startswith("typedef enum"):
+                in_enum = True
+                types = {}
+                continue
+            if in_enum and line.startswith("}"):
+                if "telemetry_type_t" in line:
+                    return types
+                in_enum = False
+                continue
+            m = ENUM_RE.match(line) if in_enum else None
+            if m:
+                fields = dict(FIELD_RE.findall(m.group(2) or ""))
+                types[len(types)] = (m.group(1)[len("TELEMETRY_"):].lower(), fields)
+    raise SystemExit("telemetry_type_t not found in %s" % header)
+
+
+def column(note):
+    """Column name of a field note, without its parenthesis"""
+    return re.sub(r"\W+", "_", re.sub(r"\(.*?\)", "", note)).strip("_").lower()
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, mirrors telemetry_crc()"""
+    crc = 0xffff
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xffff
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    at = 0
+    while at < len(data):
+        code = data[at]
+        if code == 0 or at + code > len(data):
+            return None
+        out += data[at + 1:at + code]
+        at += code
+        if code < 0xff and at < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def chunks(stream, live):
+    """Yield the bytes between zero delimiters, a live port never ends"""
+    buf = bytearray()
+    while True:
+        data = stream.read(256)
+        if not data:
+            if live:
+                continue
+            return
+        buf += data
+        while True:
+            end = buf.find(0)
+            if end < 0:
+                break
+            if end:
+                yield bytes(buf[:end])
+            del buf[:end + 1]
+
+
+def frames(stream, live, stats):
+    """Yield (seq, records) of the frames that pass the crc"""
+    last_seq = None
+    for chunk in chunks(stream, live):
+        payload = cobs_decode(chunk)
+        if (payload is None or len(payload) < 4 or (len(payload) - 4) % RECORD.size
+                or payload[0] != VERSION
+                or crc16(payload[:-2]) != struct.unpack_from("<H", payload, len(payload) - 2)[0]):
+            stats["bad"] += 1
+            continue
+        seq = payload[1]
+        if last_seq is not None and seq != (last_seq + 1) & 0xff:
+            stats["gaps"] += (seq - last_seq - 1) & 0xff
+        last_seq = seq
+        stats["frames"] += 1
+        yield seq, [RECORD.unpack_from(payload, 2 + i * RECORD.size)
+                    for i in range((len(payload) - 4) // RECORD.size)]
+
+
+def open_input(args):
+    if args.port:
+        try:
+            import serial
+        except ImportError:
+            raise SystemExit("reading a port needs pyserial: pip install pyserial")
+        return serial.Serial(args.port, args.baud, timeout=1)
+    return open(args.input, "rb") if args.input != "-" else sys.stdin.buffer
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("input", nargs="?", default="-", help="capture file, - for stdin")
+    ap.add_argument("--port", help="serial port to read live")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--header", default=HEADER)
+    args = ap.parse_args()
+
+    types = load_types(args.header)
+    # one column per distinct field name, in enum order
+    columns = []
+    for _, fields in types.values():
+        for note in fields.values():
+            name = column(note)
+            if name not in columns:
+                columns.append(name)
+    writer = csv.writer(sys.stdout, lineterminator="\n")
+    writer.writerow(["ts_ms", "seq", "record"] + columns)
+
+    stats = {"frames": 0, "bad": 0, "gaps": 0}
+    stream = open_input(args)
+    try:
+        for seq, records in frames(stream, bool(args.port), stats):
+            for ts, kind, a, b, c, d in records:
+                name, fields = types.get(kind, ("type%d" % kind, {}))
+                row = dict.fromkeys(columns, "")
+                for key, value in zip("abcd", (a, b, c, d)):
+                    if key in fields:
+                        row[column(fields[key])] = value
+                writer.writerow([ts, seq, name] + [row[col] for col in columns])
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+    print("%d frames, %d skipped as log text or corrupt, %d lost"
+          % (stats["frames"], stats["bad"], stats["gaps"]),
+          file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+@Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+@Date        : 2026-10-18 18:32:10
+@LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+@LastEditTime: 2026-10-18 18:32:13
+@FilePath    : /shellhome-nightlamp/tools/trace_decode.py
+@Description : decode TRC lines dumped by board_trace_dump()
+Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+
+Usage:
+    idf.py monitor | tee lamp.log      # long press button 2 to dump
+    tools/trace_decode.py lamp.log
+    tools/trace_decode.py --csv lamp.log > trace.csv
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      "..", "main", "board_trace.h")
+
+ENUM_RE = re.compile(r"^\s*(TRACE_\w+)\s*,?\s*(?:/\*!<\s*(.*?)\s*\*/)?\s*$")
+TRC_RE = re.compile(r"TRC ([0-9a-f]{8}) ([0-9a-f]{4}) ([0-9a-f]) "
+                    r"([0-9a-f]{8}) ([0-9a-f]{8})")
+
+
+def load_events(header):
+    """Read event names and argument notes from the trace_event_t enum"""
+    events = {}
+    in_enum = False
+    with open(header, encoding="utf-8") as f:
+        for line in f:
+            if line.startswith("typedef enum"):
+                in_enum = True
+                events = {}
+                continue
+            if in_enum and line.startswith("}"):
+                if "trace_event_t" in line:
+                    return events
+                in_enum = False
+                continue
+            m = ENUM_RE.match(line) if in_enum else None
+            if m:
+                events[len(events)] = (m.group(1)[len("TRACE_"):], m.group(2) or "")
+    raise SystemExit("trace_event_t not found in %s" % header)
+
+
+def records(lines):
+    """Yield (ts_us, event, core, a0, a1), the 32 bit timestamp unwrapped"""
+    base = 0
+    last = None
+    for line in lines:
+        m = TRC_RE.search(line)
+        if not m:
+            continue
+        ts = int(m.group(1), 16)
+        if last is not None and ts < last:
+            base += 1 << 32
+        last = ts
+        yield (base + ts, int(m.group(2), 16), int(m.group(3), 16),
+               int(m.group(4), 16), int(m.group(5), 16))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("log", nargs="?", help="console log, stdin if omitted")
+    parser.add_argument("--header", default=HEADER, help="path of board_trace.h")
+    parser.add_argument("--csv", action="store_true", help="print CSV")
+    args = parser.parse_args()
+
+    events = load_events(args.header)
+    src = open(args.log, encoding="utf-8", errors="replace") if args.log else sys.stdin
+
+    if args.csv:
+        print("ts_us,event,core,a0,a1")
+    first = None
+    prev = None
+    for ts, event, core, a0, a1 in records(src):
+        name, note = events.get(event, ("#%d" % event, ""))
+        if args.csv:
+            print("%d,%s,%d,%d,%d" % (ts, name, core, a0, a1))
+            continue
+        first = ts if first is None else first
+        delta = 0 if prev is None else ts - prev
+        prev = ts
+        print("%12.3f ms %+10.3f  core%d  %-12s a0=%-10d a1=%-10d %s" %
+              ((ts - first) / 1000.0, delta / 1000.0, core, name, a0, a1,
+               "; " + note if note else ""))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+@Author      : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+@Date        : 2026-10-19 16:20:47
+@LastEditors : kevin.z.y <kevin.cn.zhengyang@gmail.com>
+@LastEditTime: 2026-10-19 16:20:50
+@FilePath    : /shellhome-nightlamp/tools/wave_lut.py
+@Description : generate the periodic waveform tables of lamp_wave.c
+Copyright (c) 2024 by Zheng, Yang, All Rights Reserved.
+
+Run by main/CMakeLists.txt at build time, by hand for host builds:
+    tools/wave_lut.py build/lamp_wave_lut.h
+"""
+
+import math
+import sys
+
+BITS = 8                # entries per period, indexed by the top phase bits
+SIZE = 1 << BITS
+TOP = 0xffff            # samples in [0, TOP]
+
+
+def sine(x):
+    """raised cosine, at the bottom at phase 0"""
+    return (1 - math.cos(2 * math.pi * x)) / 2
+
+
+def ease(x):
+    """cubic ease in and out up, then the same way down"""
+    t = 2 * x if x < 0.5 else 2 - 2 * x
+    return t * t * (3 - 2 * t)
+
+
+def exp(x):
+    """exp of a cosine, a long dim rest and a quick swell like breathing"""
+    lo, hi = math.exp(-1), math.exp(1)
+    return (math.exp(-math.cos(2 * math.pi * x)) - lo) / (hi - lo)
+
+
+# in the order of lamp_wave_shape_t
+SHAPES = [("sine", sine), ("ease", ease), ("exp", exp)]
+
+
+def rows(values, per_line, fmt):
+    out = []
+    for i in range(0, len(values), per_line):
+        out.append("        " + " ".join(fmt % v + "," for v in values[i:i + per_line]))
+    return "\n".join(out)
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: wave_lut.py OUTPUT")
+
+    with open(sys.argv[1], "w", encoding="utf-8") as f:
+        f.write("/* generated by tools/wave_lut.py, do not edit */\n\n")
+        f.write("#define LAMP_WAVE_LUT_BITS  %d\n" % BITS)
+        f.write("#define LAMP_WAVE_LUT_NUM   %d\n\n" % len(SHAPES))
+        f.write("/* one period per shape, one extra entry for interpolation */\n")
+        f.write("static const uint16_t lamp_wave_lut[%d][%d] = {\n" % (len(SHAPES), SIZE + 1))
+        for name, shape in SHAPES:
+            table = [int(round(TOP * shape(i / SIZE))) for i in range(SIZE + 1)]
+            f.write("    /* %s */\n    {\n%s\n    },\n" % (name, rows(table, 12, "%5d")))
+        f.write("};\n")
+
+
+if __name__ == "__main__":
+    main()